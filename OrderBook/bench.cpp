@@ -0,0 +1,1396 @@
+// AI generated
+
+#include "orderbook/order_book.h"
+#include "orderbook/bar_consumer.h"
+#include "orderbook/columnar_file.h"
+#include "orderbook/consolidated_book.h"
+#include "orderbook/event_merge.h"
+#include "orderbook/options_chain.h"
+#include "orderbook/pool_handoff.h"
+#include "orderbook/sim_exchange.h"
+#include "orderbook/order_router.h"
+#include "orderbook/stream_vbyte.h"
+#include "orderbook/replay_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <malloc.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ============================================================================
+// Timing Utilities
+// ============================================================================
+
+class Timer {
+private:
+    chrono::high_resolution_clock::time_point start_time;
+
+public:
+    Timer() : start_time(chrono::high_resolution_clock::now()) {}
+
+    void reset() {
+        start_time = chrono::high_resolution_clock::now();
+    }
+
+    // Returns elapsed time in nanoseconds
+    int64_t elapsed_ns() const {
+        auto end_time = chrono::high_resolution_clock::now();
+        return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
+    }
+
+    // Returns elapsed time in microseconds
+    double elapsed_us() const {
+        return elapsed_ns() / 1000.0;
+    }
+
+    // Returns elapsed time in milliseconds
+    double elapsed_ms() const {
+        return elapsed_ns() / 1000000.0;
+    }
+};
+
+// Hardware branch counters for the calling thread, user space only. Opening
+// fails under perf_event_paranoid > 2 or in VMs without a PMU; callers then
+// report n/a.
+class BranchCounter {
+private:
+    int fd_branches = -1;
+    int fd_misses = -1;
+
+#if defined(__linux__)
+    static int open_counter(uint64_t config, int group) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+
+    static uint64_t read_counter(int fd) {
+        uint64_t value = 0;
+        return read(fd, &value, sizeof(value)) == sizeof(value) ? value : 0;
+    }
+#endif
+
+public:
+    BranchCounter() {
+#if defined(__linux__)
+        fd_branches = open_counter(PERF_COUNT_HW_BRANCH_INSTRUCTIONS, -1);
+        if (fd_branches >= 0) {
+            fd_misses = open_counter(PERF_COUNT_HW_BRANCH_MISSES, fd_branches);
+        }
+#endif
+    }
+
+    ~BranchCounter() {
+#if defined(__linux__)
+        if (fd_misses >= 0) close(fd_misses);
+        if (fd_branches >= 0) close(fd_branches);
+#endif
+    }
+
+    bool available() const {
+        return fd_misses >= 0;
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (!available()) return;
+        ioctl(fd_branches, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd_branches, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // branches and branch misses since start()
+    void stop(uint64_t& branches, uint64_t& misses) {
+        branches = misses = 0;
+#if defined(__linux__)
+        if (!available()) return;
+        ioctl(fd_branches, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        branches = read_counter(fd_branches);
+        misses = read_counter(fd_misses);
+#endif
+    }
+};
+
+// ============================================================================
+// Performance Benchmarks
+// ============================================================================
+
+struct BenchmarkResult {
+    string name;
+    double avg_ns;
+    double median_ns;
+    double min_ns;
+    double max_ns;
+    double p95_ns;
+    double p99_ns;
+
+    void print() const {
+        cout << "\n  " << name << ":\n";
+        cout << "    Avg:    " << fixed << setprecision(2) << avg_ns << " ns (" << avg_ns / 1000.0 << " us)\n";
+        cout << "    Median: " << median_ns << " ns (" << median_ns / 1000.0 << " us)\n";
+        cout << "    Min:    " << min_ns << " ns (" << min_ns / 1000.0 << " us)\n";
+        cout << "    Max:    " << max_ns << " ns (" << max_ns / 1000.0 << " us)\n";
+        cout << "    P95:    " << p95_ns << " ns (" << p95_ns / 1000.0 << " us)\n";
+        cout << "    P99:    " << p99_ns << " ns (" << p99_ns / 1000.0 << " us)\n";
+    }
+};
+
+// every result computed in this run, for --save / --compare
+vector<BenchmarkResult> all_results;
+
+BenchmarkResult calculate_stats(vector<int64_t>& timings, const string& name) {
+    sort(timings.begin(), timings.end());
+
+    BenchmarkResult result;
+    result.name = name;
+
+    double sum = accumulate(timings.begin(), timings.end(), 0.0);
+    result.avg_ns = sum / timings.size();
+    result.median_ns = timings[timings.size() / 2];
+    result.min_ns = timings.front();
+    result.max_ns = timings.back();
+    result.p95_ns = timings[static_cast<size_t>(timings.size() * 0.95)];
+    result.p99_ns = timings[static_cast<size_t>(timings.size() * 0.99)];
+
+    all_results.push_back(result);
+    return result;
+}
+
+void benchmark_add_order() {
+    const int NUM_ITERATIONS = 100000;
+    vector<int64_t> timings;
+    timings.reserve(NUM_ITERATIONS);
+
+    OrderBook book;
+    Timer timer;
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        double price = 100.0 + (i % 100) * 0.01;
+        timer.reset();
+        book.add_order(Order(i, i % 2 == 0, price, 100, i));
+        timings.push_back(timer.elapsed_ns());
+    }
+
+    auto result = calculate_stats(timings, "Add Order");
+    result.print();
+}
+
+void benchmark_cancel_order() {
+    const int NUM_ITERATIONS = 100000;
+    OrderBook book;
+
+    // Pre-populate the book
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        double price = 100.0 + (i % 100) * 0.01;
+        book.add_order(Order(i, i % 2 == 0, price, 100, i));
+    }
+
+    vector<int64_t> timings;
+    timings.reserve(NUM_ITERATIONS);
+
+    Timer timer;
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        timer.reset();
+        book.cancel_order(i);
+        timings.push_back(timer.elapsed_ns());
+    }
+
+    auto result = calculate_stats(timings, "Cancel Order");
+    result.print();
+}
+
+void benchmark_amend_order_quantity() {
+    const int NUM_ITERATIONS = 10000;
+    OrderBook book;
+
+    // Pre-populate the book
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        double price = 100.0 + (i % 100) * 0.01;
+        book.add_order(Order(i, true, price, 100, i));
+    }
+
+    vector<int64_t> timings;
+    timings.reserve(NUM_ITERATIONS);
+
+    Timer timer;
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        double price = 100.0 + (i % 100) * 0.01;
+        timer.reset();
+        book.amend_order(i, price, 200);
+        timings.push_back(timer.elapsed_ns());
+    }
+
+    auto result = calculate_stats(timings, "Amend Order (Quantity)");
+    result.print();
+}
+
+void benchmark_amend_order_price() {
+    const int NUM_ITERATIONS = 10000;
+    OrderBook book;
+
+    // Pre-populate the book
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        double price = 100.0 + (i % 100) * 0.01;
+        book.add_order(Order(i, true, price, 100, i));
+    }
+
+    vector<int64_t> timings;
+    timings.reserve(NUM_ITERATIONS);
+
+    Timer timer;
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        double old_price = 100.0 + (i % 100) * 0.01;
+        double new_price = old_price + 0.01;
+        timer.reset();
+        book.amend_order(i, new_price, 100);
+        timings.push_back(timer.elapsed_ns());
+    }
+
+    auto result = calculate_stats(timings, "Amend Order (Price)");
+    result.print();
+}
+
+void benchmark_get_snapshot() {
+    const int NUM_ORDERS = 10000;
+    const int NUM_ITERATIONS = 100000;
+
+    OrderBook book;
+
+    // Pre-populate the book
+    for (int i = 0; i < NUM_ORDERS; ++i) {
+        double price = 100.0 + (i % 1000) * 0.01;
+        book.add_order(Order(i, i % 2 == 0, price, 100, i));
+    }
+
+    vector<int64_t> timings;
+    timings.reserve(NUM_ITERATIONS);
+
+    vector<PriceLevel> bids, asks;
+    Timer timer;
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        timer.reset();
+        book.get_snapshot(10, bids, asks);
+        timings.push_back(timer.elapsed_ns());
+    }
+
+    auto result = calculate_stats(timings, "Get Snapshot (depth=10)");
+    result.print();
+}
+
+// keeps benchmarked results observable so the calls are not optimized away
+volatile uint64_t benchmark_sink = 0;
+
+void benchmark_owner_scan() {
+    const int NUM_ORDERS = 200000;
+    const int NUM_ITERATIONS = 50;
+
+    for (bool columns : {false, true}) {
+        OrderBook book(columns);
+        for (int i = 0; i < NUM_ORDERS; ++i) {
+            double price = 100.0 + (i % 1000) * 0.01;
+            book.add_order(Order(i, i % 2 == 0, price, 100, i, i % 64));
+        }
+
+        vector<int64_t> timings;
+        timings.reserve(NUM_ITERATIONS);
+
+        Timer timer;
+        for (int i = 0; i < NUM_ITERATIONS; ++i) {
+            timer.reset();
+            benchmark_sink = book.get_owner_quantity(i % 64);
+            timings.push_back(timer.elapsed_ns());
+        }
+
+        auto result = calculate_stats(timings, columns ? "Owner Scan (SoA columns, 200K orders)"
+                                                       : "Owner Scan (level walk, 200K orders)");
+        result.print();
+    }
+}
+
+// Replays a recorded event file in blocks of 64 events; each sample is the
+// per-event average of one block, which keeps timer overhead out of the
+// numbers. This is also the PGO training workload (--train).
+template<typename Book = OrderBook>
+void benchmark_replay(const vector<OrderEvent>& events, int passes, const string& label = "Replay") {
+    const size_t BLOCK = 64;
+    vector<int64_t> timings;
+    timings.reserve(events.size() / BLOCK * passes + 1);
+
+    Timer timer;
+    for (int pass = 0; pass < passes; ++pass) {
+        Book book;
+        for (size_t i = 0; i < events.size(); i += BLOCK) {
+            size_t end = min(events.size(), i + BLOCK);
+            timer.reset();
+            for (size_t j = i; j < end; ++j) {
+                book.expire_orders(events[j].timestamp_ns);
+                book.apply(events[j]);
+            }
+            timings.push_back(timer.elapsed_ns() / int64_t(end - i));
+        }
+        benchmark_sink = book.get_total_orders();
+    }
+
+    if (timings.empty()) return;
+    auto result = calculate_stats(timings, label + " (ns/event, " + to_string(events.size()) + " events)");
+    result.print();
+}
+
+// Branch misses per operation for a random add/cancel/amend churn and, when
+// given, the replay file. Build orderbook_bench_nohints for the before side
+// (OB_LIKELY / OB_UNLIKELY / OB_COLD compiled out) and --compare the two.
+void benchmark_branch_misses(const vector<OrderEvent>& events) {
+    BranchCounter counter;
+    cout << "\n  Branch misses"
+#if defined(ORDERBOOK_NO_BRANCH_HINTS)
+         << " (hints off)"
+#endif
+         << ":\n";
+    if (!counter.available()) {
+        cout << "    n/a (perf_event_open unavailable; check perf_event_paranoid)\n";
+        return;
+    }
+
+    auto report = [&](const string& name, size_t ops, uint64_t branches, uint64_t misses) {
+        double per_op = double(misses) / double(ops);
+        cout << "    " << left << setw(10) << name << right << fixed << setprecision(3)
+             << double(branches) / double(ops) << " branches/op, "
+             << per_op << " misses/op ("
+             << setprecision(2) << (branches ? 100.0 * double(misses) / double(branches) : 0.0) << "%)\n";
+        all_results.push_back(BenchmarkResult{"Branch misses/op (" + name + ")", per_op, per_op,
+                                              per_op, per_op, per_op, per_op});
+    };
+
+    // churn: ~50% add, ~40% cancel (a tenth of them for unknown ids),
+    // ~10% quantity amends
+    {
+        const size_t NUM_OPS = 500000;
+        mt19937_64 rng(42);
+        vector<pair<uint64_t, double>> live;
+        uint64_t next_id = 1;
+        OrderBook book;
+        uint64_t branches, misses;
+
+        counter.start();
+        for (size_t i = 0; i < NUM_OPS; ++i) {
+            unsigned roll = rng() % 100;
+            if (live.empty() || roll < 50) {
+                bool is_buy = rng() & 1;
+                double price = 100.0 + (is_buy ? -1.0 : 1.0) * double(1 + rng() % 50) * 0.01;
+                book.add_order(Order(next_id, is_buy, price, 1 + rng() % 500, i));
+                live.emplace_back(next_id++, price);
+            } else if (roll < 54) {
+                book.cancel_order(next_id + 1000000);
+            } else if (roll < 90) {
+                size_t pick = rng() % live.size();
+                book.cancel_order(live[pick].first);
+                live[pick] = live.back();
+                live.pop_back();
+            } else {
+                const auto& [id, price] = live[rng() % live.size()];
+                book.amend_order(id, price, 1 + rng() % 500);
+            }
+        }
+        counter.stop(branches, misses);
+        benchmark_sink = book.get_total_orders();
+        report("churn", NUM_OPS, branches, misses);
+    }
+
+    if (!events.empty()) {
+        OrderBook book;
+        uint64_t branches, misses;
+        counter.start();
+        for (const OrderEvent& ev : events) {
+            book.expire_orders(ev.timestamp_ns);
+            book.apply(ev);
+        }
+        counter.stop(branches, misses);
+        benchmark_sink = book.get_total_orders();
+        report("replay", events.size(), branches, misses);
+    }
+}
+
+// heap bytes in use (glibc), for memory comparisons; 0 where unsupported
+size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// 10K thin series (3 orders each): one OrderBook per series vs one chain
+void benchmark_options_chain() {
+    const uint32_t NUM_SERIES = 10000;
+    const int ORDERS_PER_SERIES = 3;
+
+    cout << "\n  Options chain (" << NUM_SERIES << " series x " << ORDERS_PER_SERIES << " orders):\n";
+
+    size_t before = heap_in_use();
+    {
+        vector<unique_ptr<OrderBook>> books;
+        books.reserve(NUM_SERIES);
+        for (uint32_t s = 0; s < NUM_SERIES; ++s) {
+            books.emplace_back(new OrderBook());
+            for (int i = 0; i < ORDERS_PER_SERIES; ++i) {
+                uint64_t id = uint64_t(s) * ORDERS_PER_SERIES + i;
+                books.back()->add_order(Order(id, i % 2 == 0, 1.0 + i * 0.05, 10, id));
+            }
+        }
+        size_t used = heap_in_use() - before;
+        cout << "    OrderBook per series: " << used / NUM_SERIES << " bytes/series\n";
+    }
+
+    before = heap_in_use();
+    OptionsChain chain(NUM_SERIES);
+    vector<int64_t> timings;
+    timings.reserve(NUM_SERIES * ORDERS_PER_SERIES);
+    Timer timer;
+    for (uint32_t s = 0; s < NUM_SERIES; ++s) {
+        for (int i = 0; i < ORDERS_PER_SERIES; ++i) {
+            uint64_t id = uint64_t(s) * ORDERS_PER_SERIES + i;
+            timer.reset();
+            chain.add_order(s, Order(id, i % 2 == 0, 1.0 + i * 0.05, 10, id));
+            timings.push_back(timer.elapsed_ns());
+        }
+    }
+    size_t used = heap_in_use() - before;
+    cout << "    OptionsChain:         " << used / NUM_SERIES << " bytes/series ("
+         << chain.memory_bytes() / NUM_SERIES << " by memory_bytes())\n";
+
+    auto result = calculate_stats(timings, "Options Chain Add (10K series)");
+    result.print();
+}
+
+// per-delta cost of folding four venues' level changes into the NBBO book
+void benchmark_consolidated_book() {
+    const size_t VENUES = 4;
+    const int NUM_OPS = 100000;
+    OrderBook venues[VENUES];
+    vector<LevelDelta> deltas;
+    for (auto& v : venues) v.set_delta_sink(&deltas);
+
+    ConsolidatedBook nbbo;
+    vector<int64_t> timings;
+    timings.reserve(NUM_OPS);
+    mt19937_64 rng(3);
+    Timer timer;
+
+    for (int i = 0; i < NUM_OPS; ++i) {
+        size_t v = rng() % VENUES;
+        bool is_buy = rng() & 1;
+        double price = 100.0 + (is_buy ? -1.0 : 1.0) * double(1 + rng() % 50) * 0.01;
+        if (i >= 1000 && rng() % 2) {
+            venues[v].cancel_order(i - 1000);
+        }
+        venues[v].add_order(Order(i, is_buy, price, 100, i));
+
+        timer.reset();
+        nbbo.apply(v, deltas);
+        timings.push_back(timer.elapsed_ns() / int64_t(max<size_t>(1, deltas.size())));
+        deltas.clear();
+    }
+    benchmark_sink = nbbo.get_top().bid.total_quantity;
+
+    auto result = calculate_stats(timings, "Consolidated Book Apply (ns/delta, 4 venues)");
+    result.print();
+}
+
+// Routes 500 lots each way against a 3-venue consolidated book. With a
+// replay file the venue books are the recorded flow split by order_id % 3
+// and a route is timed every 1000 events; otherwise a synthetic book.
+void benchmark_order_router(const vector<OrderEvent>& events) {
+    const size_t VENUES = 3;
+    VenueFees fees;
+    fees.take_fee = {0.0030, 0.0010, -0.0005};
+    OrderRouter<> router(fees);
+    RouteSlice slices[64];
+
+    OrderBook venues[VENUES];
+    vector<LevelDelta> deltas;
+    for (auto& v : venues) v.set_delta_sink(&deltas);
+    ConsolidatedBook nbbo;
+
+    vector<int64_t> timings;
+    Timer timer;
+    auto time_routes = [&] {
+        for (bool is_buy : {true, false}) {
+            timer.reset();
+            RouteResult r = router.route(nbbo, is_buy, 500, is_buy ? 1e9 : 0.0, slices, 64);
+            timings.push_back(timer.elapsed_ns());
+            benchmark_sink = r.filled;
+        }
+    };
+
+    if (!events.empty()) {
+        for (size_t i = 0; i < events.size(); ++i) {
+            size_t v = events[i].order_id % VENUES;
+            venues[v].apply(events[i]);
+            nbbo.apply(v, deltas);
+            deltas.clear();
+            if (i % 1000 == 999) time_routes();
+        }
+    } else {
+        mt19937_64 rng(1);
+        for (int i = 0; i < 30000; ++i) {
+            size_t v = rng() % VENUES;
+            bool is_buy = rng() & 1;
+            double price = 100.0 + (is_buy ? -1.0 : 1.0) * double(1 + rng() % 50) * 0.01;
+            venues[v].add_order(Order(i, is_buy, price, 1 + rng() % 100, i));
+            nbbo.apply(v, deltas);
+            deltas.clear();
+        }
+        for (int i = 0; i < 10000; ++i) time_routes();
+    }
+
+    if (timings.empty()) return;
+    auto result = calculate_stats(timings, events.empty() ? "Order Router (500 lots, 3 venues)"
+                                                          : "Order Router (500 lots, 3 venues, replay)");
+    result.print();
+}
+
+// per-fill cost of the 1s/1m bar aggregator (1000 symbols, ~1us apart),
+// then end-to-end throughput through the SPSC ring and consumer thread
+void benchmark_bar_aggregator() {
+    const uint32_t SYMBOLS = 1000;
+    const int NUM_FILLS = 500000;
+    mt19937_64 rng(5);
+    vector<Fill> fills(NUM_FILLS);
+    uint64_t ts = 0;
+    for (Fill& f : fills) {
+        ts += rng() % 2000;
+        f = Fill{ts, double(9900 + rng() % 200) * 0.01, 1 + rng() % 100, uint32_t(rng() % SYMBOLS),
+                 bool(rng() & 1), {}};
+    }
+
+    BarAggregator agg(SYMBOLS);
+    vector<int64_t> timings;
+    timings.reserve(NUM_FILLS);
+    Timer timer;
+    for (const Fill& f : fills) {
+        timer.reset();
+        agg.on_fill(f);
+        timings.push_back(timer.elapsed_ns());
+    }
+    benchmark_sink = agg.bars_closed();
+
+    auto result = calculate_stats(timings, "Bar Aggregator (ns/fill, 1000 symbols)");
+    result.print();
+
+    const string path = "bench_bars.obb";
+    BarConsumer consumer(SYMBOLS, path, 1);
+    consumer.start();
+    auto start = chrono::steady_clock::now();
+    for (const Fill& f : fills) {
+        while (!consumer.publish(f)) this_thread::yield();
+    }
+    consumer.stop();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    remove(path.c_str());
+    cout << "    Consumer thread: " << int64_t(NUM_FILLS / secs) << " fills/s end to end"
+         << (consumer.pinned() ? " (pinned to cpu 1)" : "") << "\n";
+}
+
+// the replay re-encoded in the columnar format with a snapshot every 100K
+// events: size, decode-only rate from the mapped file (best of 5 passes),
+// and a warm start halfway between two snapshots
+void benchmark_columnar(const vector<OrderEvent>& events) {
+    const string path = "bench_events.obc";
+    const size_t SNAPSHOT_EVERY = 100000;
+    {
+        ColumnarWriter writer(path);
+        OrderBook book;
+        vector<Order> orders;
+        for (size_t i = 0; i < events.size(); ++i) {
+            writer.write(events[i]);
+            book.expire_orders(events[i].timestamp_ns);
+            book.apply(events[i]);
+            if ((i + 1) % SNAPSHOT_EVERY == 0) {
+                book.get_orders(orders);
+                writer.write_snapshot(events[i].timestamp_ns, orders);
+            }
+        }
+    }
+    ColumnarReader reader(path);
+    if (!reader.is_open()) return;
+
+    vector<OrderEvent> chunk(reader.chunk_capacity());
+    double best = 1e30;
+    for (int pass = 0; pass < 5; ++pass) {
+        uint64_t sink = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t c = 0; c < reader.chunks(); ++c) {
+            size_t n = reader.decode(c, chunk.data());
+            sink += n ? chunk[n - 1].order_id : 0;
+        }
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        benchmark_sink = sink;
+    }
+
+    // halfway between two snapshots past the session midpoint
+    uint64_t mid = events[min(events.size() - 1, events.size() / 2 + SNAPSHOT_EVERY / 2)].timestamp_ns;
+    double warm = 1e30;
+    uint64_t replayed = 0;
+    for (int pass = 0; pass < 5; ++pass) {
+        OrderBook book;
+        ColumnarCursor cursor(reader);
+        auto start = chrono::steady_clock::now();
+        replayed = cursor.seek(book, mid);
+        warm = min(warm, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        benchmark_sink = book.get_total_orders();
+    }
+
+    cout << "\n  Columnar file (" << events.size() << " events, " << reader.snapshots() << " snapshots):\n"
+         << "    Size:       " << fixed << setprecision(2) << double(reader.file_bytes()) / double(events.size())
+         << " bytes/event vs " << sizeof(OrderEvent) << " row\n"
+         << "    Decode:     " << double(events.size()) / best / 1e6 << " M events/s ("
+         << double(reader.file_bytes()) / best / 1e9 << " GB/s compressed in)\n"
+         << "    Warm start: " << warm * 1000.0 << " ms to mid-session (" << replayed
+         << " events after the snapshot)\n";
+    remove(path.c_str());
+}
+
+// K-way merge of per-venue feeds: the replay (or synthetic flow) split by
+// order id into k time-sorted streams, merged back with the loser tree and,
+// for reference, a binary heap; then merged into one book per venue
+void benchmark_event_merge(const vector<OrderEvent>& events) {
+    vector<OrderEvent> flow = events;
+    if (flow.empty()) {
+        mt19937_64 rng(31);
+        uint64_t ts = 0;
+        for (size_t i = 0; i < 2000000; ++i) {
+            ts += 1 + rng() % 2000;
+            flow.push_back(OrderEvent::cancel(1 + rng() % 1000000, ts));
+        }
+    }
+
+    cout << "\n  Event merge (" << flow.size() << " events):\n";
+    for (uint32_t k : {16u, 256u}) {
+        vector<vector<OrderEvent>> feeds(k);
+        for (const OrderEvent& ev : flow) feeds[ev.order_id % k].push_back(ev);
+
+        double best = 1e30;
+        for (int pass = 0; pass < 5; ++pass) {
+            EventMerger merger;
+            for (const auto& f : feeds) merger.add_stream(f.data(), f.size());
+            merger.start();
+            uint64_t sink = 0;
+            auto start = chrono::steady_clock::now();
+            merger.drain([&](uint32_t s, const OrderEvent& ev) { sink += ev.order_id ^ s; });
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            benchmark_sink = sink;
+        }
+
+        // (timestamp, stream) min-heap over the same feeds
+        double heap = 1e30;
+        for (int pass = 0; pass < 3; ++pass) {
+            using Head = pair<uint64_t, uint32_t>;
+            priority_queue<Head, vector<Head>, greater<Head>> pq;
+            vector<size_t> pos(k, 0);
+            for (uint32_t s = 0; s < k; ++s) {
+                if (!feeds[s].empty()) pq.emplace(feeds[s][0].timestamp_ns, s);
+            }
+            uint64_t sink = 0;
+            auto start = chrono::steady_clock::now();
+            while (!pq.empty()) {
+                uint32_t s = pq.top().second;
+                pq.pop();
+                sink += feeds[s][pos[s]].order_id ^ s;
+                if (++pos[s] < feeds[s].size()) pq.emplace(feeds[s][pos[s]].timestamp_ns, s);
+            }
+            heap = min(heap, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            benchmark_sink = sink;
+        }
+
+        cout << "    " << setw(3) << k << " streams: " << fixed << setprecision(1)
+             << double(flow.size()) / best / 1e6 << " M events/s loser tree, "
+             << double(flow.size()) / heap / 1e6 << " M events/s binary heap\n";
+    }
+
+    if (!events.empty()) {
+        // 16 venue books fed in timestamp order
+        const uint32_t k = 16;
+        vector<vector<OrderEvent>> feeds(k);
+        for (const OrderEvent& ev : events) feeds[ev.order_id % k].push_back(ev);
+        vector<unique_ptr<OrderBook>> books;
+        for (uint32_t s = 0; s < k; ++s) books.push_back(make_unique<OrderBook>());
+        EventMerger merger;
+        for (const auto& f : feeds) merger.add_stream(f.data(), f.size());
+        merger.start();
+        auto start = chrono::steady_clock::now();
+        uint64_t n = merger.drain([&](uint32_t s, const OrderEvent& ev) {
+            books[s]->expire_orders(ev.timestamp_ns);
+            books[s]->apply(ev);
+        });
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "    Merge + apply to 16 venue books: " << double(n) / elapsed / 1e6 << " M events/s\n";
+        benchmark_sink = books[0]->get_total_orders();
+    }
+}
+
+// Simulated venue: the replay with cancels at the touch turned into trades,
+// and a strategy quoting both sides through lognormal order-entry latency
+// (cancel / requote every 5000 market data events)
+void benchmark_sim_exchange(const vector<OrderEvent>& events) {
+    vector<OrderEvent> flow = events;
+    {
+        OrderBook book;
+        for (OrderEvent& ev : flow) {
+            book.expire_orders(ev.timestamp_ns);
+            if (ev.type == EventType::Cancel) {
+                const Order* o = book.find_order(ev.order_id);
+                TopOfBook top = book.get_top();
+                if (o && o->price == (o->is_buy ? top.bid.price : top.ask.price)) {
+                    ev = OrderEvent::execute(ev.order_id, o->price, o->quantity, ev.timestamp_ns);
+                }
+            }
+            book.apply(ev);
+        }
+    }
+
+    struct Quoter {
+        SimExchange* sim = nullptr;
+        uint64_t seen = 0, bid = 0, ask = 0;
+        double bid_px = 0.0, ask_px = 0.0;
+        void on_market(const OrderEvent& ev, uint64_t local_ns) {
+            if (ev.type == EventType::Add) (ev.is_buy ? bid_px : ask_px) = ev.price;
+            if (++seen % 5000 != 0 || bid_px == 0.0 || ask_px == 0.0) return;
+            if (bid) sim->cancel(bid, local_ns);
+            if (ask) sim->cancel(ask, local_ns);
+            bid = sim->submit(true, bid_px, 100, local_ns);
+            ask = sim->submit(false, ask_px, 100, local_ns);
+        }
+        void on_report(const SimReport&) {}
+    };
+
+    SimLatency paths{LatencyModel::lognormal(20000, 30000, 0.5), LatencyModel::uniform(5000, 15000),
+                     LatencyModel::lognormal(20000, 30000, 0.5)};
+    double best = 1e30;
+    SimStats stats;
+    for (int pass = 0; pass < 3; ++pass) {
+        auto sim = make_unique<SimExchange>(paths);
+        Quoter q;
+        q.sim = sim.get();
+        auto start = chrono::steady_clock::now();
+        sim->run(flow.data(), flow.size(), q);
+        sim->finish(q);
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        stats = sim->stats();
+    }
+
+    double rate = double(flow.size()) / best;
+    cout << "\n  Simulated venue (" << flow.size() << " events, " << stats.orders << " orders, "
+         << stats.fills << " fills):\n"
+         << "    " << fixed << setprecision(2) << rate / 1e6 << " M events/s, "
+         << setprecision(0) << rate * 86400.0 / (double(flow.size()) * 252.0)
+         << " trading years (252 sessions) of this flow per day\n";
+}
+
+// time-stamp counter reads for cycle counts (ns elsewhere); on other
+// targets this is ns, so the ratios still hold
+inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Cancel bursts against a book far larger than the caches: one by one vs
+// the software-pipelined cancel_orders, cycles per cancel from the TSC
+void benchmark_cancel_burst() {
+    const size_t kOrders = 1000000;
+    const size_t kBurst = 64;
+    mt19937_64 rng(97);
+
+    // sparse ids, resting in random order across 1000 levels per side
+    vector<uint64_t> ids(kOrders);
+    for (size_t i = 0; i < kOrders; ++i) ids[i] = 1 + i * 7;
+    shuffle(ids.begin(), ids.end(), rng);
+    vector<Order> orders;
+    orders.reserve(kOrders);
+    for (size_t i = 0; i < kOrders; ++i) {
+        bool is_buy = ids[i] % 2;
+        double price = is_buy ? 100.0 - double(rng() % 1000) * 0.01 : 100.01 + double(rng() % 1000) * 0.01;
+        orders.emplace_back(ids[i], is_buy, price, 100, i);
+    }
+    shuffle(ids.begin(), ids.end(), rng);
+
+    cout << "\n  Cancel bursts (" << kOrders << " resting orders, bursts of " << kBurst << "):\n";
+    double one_by_one = 0, pipelined = 0;
+    for (int pipeline = 0; pipeline < 2; ++pipeline) {
+        double best = 1e30;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto book = make_unique<OrderBook>();
+            book->reserve(kOrders);
+            for (const Order& o : orders) book->add_order(o);
+
+            size_t canceled = 0;
+            uint64_t start = read_tsc();
+            for (size_t i = 0; i < kOrders; i += kBurst) {
+                size_t n = min(kBurst, kOrders - i);
+                if (pipeline) {
+                    canceled += book->cancel_orders(&ids[i], n);
+                } else {
+                    for (size_t j = 0; j < n; ++j) canceled += book->cancel_order(ids[i + j]);
+                }
+            }
+            best = min(best, double(read_tsc() - start) / double(kOrders));
+            benchmark_sink = canceled;
+        }
+        (pipeline ? pipelined : one_by_one) = best;
+    }
+    cout << "    cancel_order loop:     " << fixed << setprecision(1) << one_by_one << " cycles/cancel\n";
+    cout << "    cancel_orders (batch): " << pipelined << " cycles/cancel ("
+         << one_by_one - pipelined << " saved)\n";
+}
+
+// Batched apply vs one event at a time, both with a delta sink drained per
+// batch of 64: a synthetic burst (adds, cancels, amends and trades spread
+// over a 1M-order book, like the open) and, when given, the replay
+// (expiry swept once per batch)
+void benchmark_batch_apply(const vector<OrderEvent>& events) {
+    const size_t kOrders = 1000000;
+    const size_t kBatch = 64;
+    mt19937_64 rng(98);
+
+    vector<OrderEvent> seed, burst;
+    vector<uint64_t> live;
+    for (uint64_t i = 0; i < kOrders; ++i) {
+        bool is_buy = rng() & 1;
+        double price = is_buy ? 100.0 - double(rng() % 500) * 0.01 : 100.01 + double(rng() % 500) * 0.01;
+        seed.push_back(OrderEvent::add(Order(1 + i * 7, is_buy, price, 100, i)));
+        live.push_back(1 + i * 7);
+    }
+    shuffle(seed.begin(), seed.end(), rng);
+    uint64_t next_id = 1 + kOrders * 7;
+    for (uint64_t ts = kOrders; burst.size() < kOrders; ++ts) {
+        unsigned roll = rng() % 10;
+        size_t pick = rng() % live.size();
+        uint64_t id = live[pick];
+        if (roll < 3) {
+            bool is_buy = rng() & 1;
+            double price = is_buy ? 100.0 - double(rng() % 500) * 0.01 : 100.01 + double(rng() % 500) * 0.01;
+            burst.push_back(OrderEvent::add(Order(next_id, is_buy, price, 100, ts)));
+            live.push_back(next_id++);
+        } else if (roll < 7) {
+            burst.push_back(OrderEvent::cancel(id, ts));
+            live[pick] = live.back();
+            live.pop_back();
+        } else if (roll < 9) {
+            burst.push_back(OrderEvent::amend(id, 0, 50, ts));      // price filled in below
+        } else {
+            burst.push_back(OrderEvent::execute(id, 0, 10, ts));
+        }
+    }
+    {
+        // amend in place: look up the resting price
+        OrderBook probe;
+        for (const OrderEvent& ev : seed) probe.apply(ev);
+        for (OrderEvent& ev : burst) {
+            if (ev.type != EventType::Add && probe.find_order(ev.order_id)) {
+                ev.price = probe.find_order(ev.order_id)->price;
+            }
+            probe.apply(ev);
+        }
+    }
+
+    auto run = [&](const vector<OrderEvent>& pre, const vector<OrderEvent>& flow, bool batched, bool expire) {
+        double best = 1e30;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto book = make_unique<OrderBook>();
+            book->reserve(kOrders);
+            for (const OrderEvent& ev : pre) book->apply(ev);
+            vector<LevelDelta> deltas;
+            book->set_delta_sink(&deltas);
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < flow.size(); i += kBatch) {
+                size_t n = min(kBatch, flow.size() - i);
+                if (expire) book->expire_orders(flow[i].timestamp_ns);
+                if (batched) {
+                    book->apply(&flow[i], n);
+                } else {
+                    for (size_t j = i; j < i + n; ++j) book->apply(flow[j]);
+                }
+                benchmark_sink = deltas.size();
+                deltas.clear();
+            }
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        return double(flow.size()) / best / 1e6;
+    };
+
+    cout << "\n  Batched apply (batches of " << kBatch << ", delta sink on):\n";
+    cout << "    Burst on a 1M-order book: " << fixed << setprecision(1) << run(seed, burst, false, false)
+         << " M events/s one by one, " << run(seed, burst, true, false) << " M events/s batched\n";
+    if (!events.empty()) {
+        cout << "    Replay:                   " << run({}, events, false, true) << " M events/s one by one, "
+             << run({}, events, true, true) << " M events/s batched\n";
+    }
+}
+
+// Ladder level upkeep with and without the branch-free kernels
+// (kBranchlessLevels) on random churn over thin levels - a few orders per
+// tick, so whether a cancel hits the head, the tail or empties the level
+// is a coin flip. ns/op, plus branch misses/op where perf events work
+struct BranchyLadderConfig : LadderConfig<100, 1024, (1u << 22)> {
+    static constexpr bool kBranchlessLevels = false;
+};
+
+template<typename Book>
+void run_level_kernels(const vector<OrderEvent>& flow, const string& name) {
+    BranchCounter counter;
+    double best = 1e30;
+    uint64_t branches = 0, misses = 0;
+    for (int pass = 0; pass < 3; ++pass) {
+        auto book = make_unique<Book>();
+        counter.start();
+        auto start = chrono::steady_clock::now();
+        for (const OrderEvent& ev : flow) book->apply(ev);
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        counter.stop(branches, misses);
+        benchmark_sink = book->get_total_orders();
+    }
+    cout << "    " << left << setw(12) << name << right << fixed << setprecision(1)
+         << best * 1e9 / double(flow.size()) << " ns/op";
+    if (counter.available()) {
+        cout << ", " << setprecision(3) << double(misses) / double(flow.size()) << " branch misses/op";
+    }
+    cout << "\n";
+}
+
+void benchmark_branchless_levels() {
+    const size_t NUM_OPS = 2000000;
+    mt19937_64 rng(99);
+    vector<OrderEvent> flow;
+    vector<uint64_t> live;
+    uint64_t next_id = 1;
+    for (size_t i = 0; i < NUM_OPS; ++i) {
+        if (live.empty() || rng() % 100 < (live.size() < 300 ? 60u : 40u)) {
+            bool is_buy = rng() & 1;
+            double price = 100.0 + (is_buy ? -1.0 : 1.0) * double(1 + rng() % 100) * 0.01;
+            flow.push_back(OrderEvent::add(Order(next_id, is_buy, price, 1 + rng() % 500, i)));
+            live.push_back(next_id++);
+        } else {
+            size_t pick = rng() % live.size();
+            flow.push_back(OrderEvent::cancel(live[pick], i));
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+
+    cout << "\n  Ladder level kernels (" << flow.size() << " ops, ~3 orders per level):\n";
+    run_level_kernels<BasicOrderBook<BranchyLadderConfig>>(flow, "branchy");
+    run_level_kernels<BasicOrderBook<LadderConfig<100, 1024, (1u << 22)>>>(flow, "branchless");
+}
+
+// Gateway -> book handoff of pooled events on two threads: PoolHandoff
+// (owner-only pool, batched returns) vs one pool shared under a mutex that
+// both threads take per event. Book threads apply to an OrderBook
+void benchmark_pool_handoff() {
+    const size_t N = 2000000;
+    const size_t kSlots = 4096;
+    mt19937_64 rng(100);
+    vector<OrderEvent> flow;
+    vector<uint64_t> live;
+    for (uint64_t ts = 1; flow.size() < N; ++ts) {
+        if (live.empty() || rng() % 2) {
+            bool is_buy = rng() & 1;
+            double price = 100.0 + (is_buy ? -1.0 : 1.0) * double(1 + rng() % 50) * 0.01;
+            flow.push_back(OrderEvent::add(Order(ts, is_buy, price, 100, ts)));
+            live.push_back(ts);
+        } else {
+            size_t pick = rng() % live.size();
+            flow.push_back(OrderEvent::cancel(live[pick], ts));
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+
+    double handoff_s, mutex_s;
+    {
+        PoolHandoff<OrderEvent> handoff(kSlots);
+        OrderBook book;
+        auto start = chrono::steady_clock::now();
+        thread gateway([&] {
+            for (const OrderEvent& ev : flow) {
+                PoolHandoff<OrderEvent>::Handle h;
+                while ((h = handoff.allocate(ev)) == PoolHandoff<OrderEvent>::kNullHandle) this_thread::yield();
+                handoff.send(h);
+            }
+        });
+        for (size_t done = 0; done < N;) {
+            size_t n = handoff.consume([&](const OrderEvent& ev) { book.apply(ev); });
+            if (n == 0) {
+                handoff.flush();
+                this_thread::yield();
+            }
+            done += n;
+        }
+        gateway.join();
+        handoff_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        benchmark_sink = book.get_total_orders();
+    }
+    {
+        MemoryPool<OrderEvent> pool;
+        pool.reserve(kSlots);
+        mutex lock;
+        SpscQueue<uint32_t> forward(kSlots * 2);
+        OrderBook book;
+        auto start = chrono::steady_clock::now();
+        thread gateway([&] {
+            for (const OrderEvent& ev : flow) {
+                uint32_t h;
+                for (;;) {
+                    {
+                        lock_guard<mutex> guard(lock);
+                        if (pool.size() < kSlots) {
+                            h = pool.allocate(ev);
+                            break;
+                        }
+                    }
+                    this_thread::yield();
+                }
+                while (!forward.push(h)) this_thread::yield();
+            }
+        });
+        for (size_t done = 0; done < N;) {
+            uint32_t h;
+            if (!forward.pop(h)) {
+                this_thread::yield();
+                continue;
+            }
+            OrderEvent ev;
+            {
+                lock_guard<mutex> guard(lock);
+                ev = pool.at(h);
+                pool.deallocate(h);
+            }
+            book.apply(ev);
+            ++done;
+        }
+        gateway.join();
+        mutex_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        benchmark_sink = book.get_total_orders();
+    }
+
+    cout << "\n  Pool handoff, gateway -> book thread (" << N << " events, " << kSlots << " slots):\n";
+    cout << "    PoolHandoff (batched returns): " << fixed << setprecision(1) << double(N) / handoff_s / 1e6
+         << " M events/s\n";
+    cout << "    Shared pool under a mutex:     " << double(N) / mutex_s / 1e6 << " M events/s\n";
+}
+
+// Stream VByte encode / decode throughput (GB/s of uint32 values) on the
+// integer columns of the replay, or synthetic ones: quantities raw, time,
+// price-tick and id columns as deltas. LEB128 varint decode for reference
+void benchmark_stream_vbyte(const vector<OrderEvent>& events) {
+    const size_t N = 1 << 20;
+    mt19937_64 rng(23);
+    vector<uint32_t> qty(N), dt(N), ticks(N), ids(N);
+    uint32_t t = 0, px = 10000, id = 1;
+    for (size_t i = 0; i < N; ++i) {
+        if (!events.empty()) {
+            const OrderEvent& ev = events[i % events.size()];
+            qty[i] = uint32_t(ev.quantity);
+            t = uint32_t(ev.timestamp_ns);
+            px = ev.type == EventType::Cancel ? px : uint32_t(llround(ev.price * 100.0));
+            id = uint32_t(ev.order_id);
+        } else {
+            qty[i] = 1 + uint32_t(rng() % 500);
+            t += 1 + uint32_t(rng() % 2000);
+            px += uint32_t(int32_t(rng() % 7) - 3);
+            id = rng() % 2 ? id + 1 : uint32_t(id - rng() % 5000);
+        }
+        dt[i] = t;
+        ticks[i] = px;
+        ids[i] = id;
+    }
+
+    const char* kernel = StreamVByte::kVectorized ?
+#if defined(__AVX2__)
+        "AVX2" : "scalar";
+#else
+        "SSSE3" : "scalar";
+#endif
+    cout << "\n  Stream VByte (" << N << " values per column, " << kernel << " decode):\n";
+
+    vector<uint8_t> buf(StreamVByte::max_encoded_bytes(N));
+    vector<uint32_t> out(N);
+    auto gbps = [&](auto&& f) {
+        double best = 1e30;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto start = chrono::steady_clock::now();
+            f();
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        return double(N * sizeof(uint32_t)) / best / 1e9;
+    };
+
+    struct Column { const char* name; const vector<uint32_t>* values; bool delta; };
+    for (const Column& c : {Column{"quantity", &qty, false}, Column{"timestamp", &dt, true},
+                            Column{"price ticks", &ticks, true}, Column{"order id", &ids, true}}) {
+        const uint32_t* in = c.values->data();
+        size_t bytes = 0;
+        double enc = gbps([&] {
+            bytes = c.delta ? StreamVByte::encode_delta(in, N, buf.data()) : StreamVByte::encode(in, N, buf.data());
+        });
+        double dec = gbps([&] {
+            if (c.delta) StreamVByte::decode_delta(buf.data(), bytes, N, out.data());
+            else StreamVByte::decode(buf.data(), bytes, N, out.data());
+        });
+        double scalar = gbps([&] {
+            if (c.delta) StreamVByte::decode_delta_scalar(buf.data(), N, out.data());
+            else StreamVByte::decode_scalar(buf.data(), N, out.data());
+        });
+        benchmark_sink = out[N - 1];
+
+        // the same values as LEB128 varints (zigzag deltas where used)
+        vector<uint8_t> leb;
+        uint32_t prev = 0;
+        for (size_t i = 0; i < N; ++i) {
+            put_varint(leb, c.delta ? zigzag_encode(int32_t(in[i] - prev)) : in[i]);
+            prev = in[i];
+        }
+        double varint = gbps([&] {
+            const uint8_t* p = leb.data();
+            uint32_t acc = 0;
+            for (size_t i = 0; i < N; ++i) {
+                uint64_t v = get_varint(p);
+                acc = c.delta ? acc + uint32_t(zigzag_decode(v)) : uint32_t(v);
+                out[i] = acc;
+            }
+        });
+
+        cout << "    " << setw(12) << left << c.name << right << fixed << setprecision(2)
+             << double(bytes) / N << " B/value  encode " << enc << " GB/s  decode " << dec
+             << " GB/s (scalar " << scalar << ", LEB128 " << varint << ")\n";
+    }
+}
+
+void stress_test_large_book() {
+    cout << "\n" << string(70, '=') << "\n";
+    cout << "STRESS TEST: Large Order Book\n";
+    cout << string(70, '=') << "\n";
+
+    const int NUM_ORDERS = 100000;
+    OrderBook book;
+
+    Timer timer;
+
+    // Add orders
+    timer.reset();
+    for (int i = 0; i < NUM_ORDERS; ++i) {
+        double price = 100.0 + (i % 1000) * 0.01;
+        book.add_order(Order(i, i % 2 == 0, price, 100 + i % 100, i));
+    }
+    double add_time_ms = timer.elapsed_ms();
+
+    cout << "\nAdded " << NUM_ORDERS << " orders in " << fixed << setprecision(2)
+              << add_time_ms << " ms\n";
+    cout << "Average: " << (add_time_ms * 1000000.0 / NUM_ORDERS) << " ns per order\n";
+
+    cout << "\nBook statistics:\n";
+    cout << "  Total orders: " << book.get_total_orders() << "\n";
+    cout << "  Bid levels: " << book.get_bid_levels() << "\n";
+    cout << "  Ask levels: " << book.get_ask_levels() << "\n";
+
+    // Cancel half the orders
+    timer.reset();
+    for (int i = 0; i < NUM_ORDERS / 2; ++i) {
+        book.cancel_order(i * 2);
+    }
+    double cancel_time_ms = timer.elapsed_ms();
+
+    cout << "\nCanceled " << (NUM_ORDERS / 2) << " orders in " << cancel_time_ms << " ms\n";
+    cout << "Average: " << (cancel_time_ms * 1000000.0 / (NUM_ORDERS / 2)) << " ns per cancel\n";
+
+    cout << "\nBook statistics after cancels:\n";
+    cout << "  Total orders: " << book.get_total_orders() << "\n";
+    cout << "  Bid levels: " << book.get_bid_levels() << "\n";
+    cout << "  Ask levels: " << book.get_ask_levels() << "\n";
+}
+
+// ============================================================================
+// Baselines
+// ============================================================================
+
+// one line per result: name<TAB>median<TAB>avg<TAB>p99
+bool save_results(const string& path) {
+    ofstream out(path);
+    if (!out) return false;
+    out << fixed << setprecision(2);
+    for (const auto& r : all_results) {
+        out << r.name << '\t' << r.median_ns << '\t' << r.avg_ns << '\t' << r.p99_ns << '\n';
+    }
+    return bool(out);
+}
+
+bool compare_results(const string& path) {
+    ifstream in(path);
+    if (!in) return false;
+
+    vector<BenchmarkResult> baseline;
+    string line;
+    while (getline(in, line)) {
+        size_t a = line.find('\t');
+        if (a == string::npos) continue;
+        BenchmarkResult r{};
+        r.name = line.substr(0, a);
+        if (sscanf(line.c_str() + a + 1, "%lf\t%lf\t%lf", &r.median_ns, &r.avg_ns, &r.p99_ns) != 3) continue;
+        baseline.push_back(r);
+    }
+
+    cout << "\n" << string(70, '=') << "\n";
+    cout << "DELTA vs " << path << " (negative = faster)\n";
+    cout << string(70, '=') << "\n";
+    cout << fixed << setprecision(1);
+    for (const auto& cur : all_results) {
+        auto it = find_if(baseline.begin(), baseline.end(),
+                          [&](const BenchmarkResult& b) { return b.name == cur.name; });
+        if (it == baseline.end()) continue;
+        auto pct = [](double before, double after) {
+            return before > 0 ? (after - before) * 100.0 / before : 0.0;
+        };
+        cout << "  " << left << setw(44) << cur.name << right
+             << " median " << setw(8) << it->median_ns << " -> " << setw(8) << cur.median_ns
+             << " (" << showpos << pct(it->median_ns, cur.median_ns) << "%)"
+             << "  avg " << pct(it->avg_ns, cur.avg_ns) << "%" << noshowpos << "\n";
+    }
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static int usage() {
+    cerr << "usage: orderbook_bench [--replay FILE [--passes N]] [--train]\n"
+         << "                       [--save FILE] [--compare FILE]\n";
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    string replay_path, save_path, compare_path;
+    int passes = 3;
+    bool train = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--passes" && i + 1 < argc) {
+            passes = max(1, atoi(argv[++i]));
+        } else if (arg == "--train") {
+            train = true;
+        } else if (arg == "--save" && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (arg == "--compare" && i + 1 < argc) {
+            compare_path = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+
+    vector<OrderEvent> events;
+    if (!replay_path.empty() && !ReplayReader::read_all(replay_path, events)) {
+        cerr << "failed to read " << replay_path << "\n";
+        return 1;
+    }
+
+    // PGO training: run only the recorded flow so the profile reflects it
+    if (train) {
+        if (events.empty()) return usage();
+        benchmark_replay(events, passes);
+        return 0;
+    }
+
+    cout << "\n" << string(70, '=') << "\n";
+    cout << "PERFORMANCE BENCHMARKS\n";
+    cout << string(70, '=') << "\n";
+
+    benchmark_add_order();
+    benchmark_cancel_order();
+    benchmark_cancel_burst();
+    benchmark_amend_order_quantity();
+    benchmark_amend_order_price();
+    benchmark_get_snapshot();
+    benchmark_owner_scan();
+    benchmark_options_chain();
+    benchmark_consolidated_book();
+    benchmark_order_router(events);
+    benchmark_bar_aggregator();
+    benchmark_stream_vbyte(events);
+    benchmark_event_merge(events);
+    benchmark_batch_apply(events);
+    benchmark_pool_handoff();
+    if (!events.empty()) {
+        benchmark_replay(events, passes);
+        benchmark_columnar(events);
+        benchmark_sim_exchange(events);
+        // 0.01 tick, 4096-tick ladder per side, direct ids below 2^23
+        benchmark_replay<BasicOrderBook<LadderConfig<100, 4096, (1u << 23)>>>(events, passes, "Replay, ladder book");
+    }
+    benchmark_branch_misses(events);
+    benchmark_branchless_levels();
+
+    stress_test_large_book();
+
+    // Demonstrate the order book
+    cout << "\n" << string(70, '=') << "\n";
+    cout << "DEMONSTRATION\n";
+    cout << string(70, '=') << "\n";
+
+    OrderBook demo_book;
+
+    // Add some orders
+    demo_book.add_order(Order(1, true, 99.50, 100, 1000));
+    demo_book.add_order(Order(2, true, 99.45, 200, 2000));
+    demo_book.add_order(Order(3, true, 99.40, 150, 3000));
+    demo_book.add_order(Order(4, true, 99.50, 50, 4000));
+
+    demo_book.add_order(Order(5, false, 100.00, 100, 5000));
+    demo_book.add_order(Order(6, false, 100.05, 200, 6000));
+    demo_book.add_order(Order(7, false, 100.10, 150, 7000));
+    demo_book.add_order(Order(8, false, 100.00, 75, 8000));
+
+    demo_book.print_book(5);
+
+    if (!save_path.empty() && !save_results(save_path)) {
+        cerr << "failed to write " << save_path << "\n";
+        return 1;
+    }
+    if (!compare_path.empty() && !compare_results(compare_path)) {
+        cerr << "failed to read " << compare_path << "\n";
+        return 1;
+    }
+
+    cout << "\nAll benchmarks completed successfully!\n\n";
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "orderbook/compiler.h"
+#include "orderbook/timer_wheel.h"
+
+// One execution as reported by a venue or matching engine.
+struct Fill {
+    uint64_t timestamp_ns;
+    double price;
+    uint64_t quantity;
+    uint32_t symbol;
+    bool is_buy;            // aggressor side
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(Fill) == 32, "Fill is copied through SPSC rings");
+
+// OHLCV bar over [start_ns, start_ns + interval_ns).
+struct Bar {
+    uint64_t start_ns = 0;
+    uint64_t interval_ns = 0;
+    uint32_t symbol = 0;
+    uint32_t trades = 0;
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    uint64_t volume = 0;
+    uint64_t buy_volume = 0;    // volume where the aggressor bought
+    double notional = 0.0;      // sum of price * quantity
+
+    double vwap() const { return volume ? notional / double(volume) : 0.0; }
+};
+
+// Streaming OHLCV / VWAP aggregator. Every (symbol, interval) pair has one
+// open bar and a fixed ring of the last RingBars completed bars, all sized
+// at construction, so on_fill() never allocates.
+//
+// Bars are aligned to multiples of their interval and only exist for
+// intervals that traded. Rollover is driven by the timer wheel: each open bar
+// arms a timer at its end, and advance(now) closes every bar whose end has
+// passed - including symbols that have gone quiet - without scanning all
+// open bars. on_fill() advances to the fill's timestamp first, so bars close
+// on event time and replays are deterministic. A fill older than its open
+// bar (out of order) is folded into that bar; one whose interval has already
+// closed is emitted as a one-trade bar of its own.
+template<size_t RingBars = 512>
+class BasicBarAggregator {
+    static_assert(RingBars && (RingBars & (RingBars - 1)) == 0, "RingBars must be a power of two");
+
+public:
+    static constexpr uint64_t kSecond = 1000000000ull;
+    static constexpr uint64_t kMinute = 60 * kSecond;
+
+private:
+    struct Slot {
+        Bar open;
+        bool active = false;
+        uint64_t completed = 0;     // bars pushed into the ring
+    };
+
+    size_t symbol_count;
+    std::vector<uint64_t> intervals;
+    std::vector<Slot> slots;        // symbol * intervals.size() + interval
+    std::vector<Bar> rings;         // slot * RingBars + completed % RingBars
+    TimerWheel wheel;
+    std::vector<Bar>* bar_sink = nullptr;
+    uint64_t closed = 0;
+
+    void close(TimerWheel::Handle h) {
+        Slot& slot = slots[h];
+        rings[size_t(h) * RingBars + (slot.completed & (RingBars - 1))] = slot.open;
+        ++slot.completed;
+        slot.active = false;
+        ++closed;
+        if (bar_sink) bar_sink->push_back(slot.open);
+    }
+
+public:
+    explicit BasicBarAggregator(size_t symbols, std::vector<uint64_t> intervals_ns = {kSecond, kMinute})
+        : symbol_count(symbols), intervals(std::move(intervals_ns)),
+          slots(symbols * intervals.size()), rings(slots.size() * RingBars) {
+        wheel.reserve(slots.size());
+    }
+
+    BasicBarAggregator(const BasicBarAggregator&) = delete;
+    BasicBarAggregator& operator=(const BasicBarAggregator&) = delete;
+
+    // append each bar as it closes (nullptr to stop)
+    void set_bar_sink(std::vector<Bar>* sink) {
+        bar_sink = sink;
+    }
+
+    // false for an unknown symbol
+    bool on_fill(const Fill& fill) {
+        if (OB_UNLIKELY(fill.symbol >= symbol_count)) {
+            return false;
+        }
+        advance(fill.timestamp_ns);
+
+        const double notional = fill.price * double(fill.quantity);
+        for (size_t i = 0; i < intervals.size(); ++i) {
+            TimerWheel::Handle h = TimerWheel::Handle(fill.symbol * intervals.size() + i);
+            Slot& slot = slots[h];
+            uint64_t start = fill.timestamp_ns - fill.timestamp_ns % intervals[i];
+
+            Bar& bar = slot.open;
+            bool late = false;
+            if (!slot.active) {
+                slot.active = true;
+                bar = Bar();
+                bar.start_ns = start;
+                bar.interval_ns = intervals[i];
+                bar.symbol = fill.symbol;
+                bar.open = bar.high = bar.low = fill.price;
+                late = !wheel.schedule(h, start + intervals[i], fill.timestamp_ns);
+            }
+
+            bar.high = fill.price > bar.high ? fill.price : bar.high;
+            bar.low = fill.price < bar.low ? fill.price : bar.low;
+            bar.close = fill.price;
+            bar.volume += fill.quantity;
+            bar.buy_volume += fill.is_buy ? fill.quantity : 0;
+            bar.notional += notional;
+            ++bar.trades;
+
+            if (OB_UNLIKELY(late)) {
+                close(h);
+            }
+        }
+        return true;
+    }
+
+    // close every bar that ended at or before now_ns; returns the number closed
+    size_t advance(uint64_t now_ns) {
+        return wheel.advance(now_ns, [this](TimerWheel::Handle h) { close(h); });
+    }
+
+    // close all open bars regardless of time (end of session / shutdown)
+    size_t flush() {
+        size_t n = 0;
+        for (size_t h = 0; h < slots.size(); ++h) {
+            if (!slots[h].active) continue;
+            wheel.cancel(TimerWheel::Handle(h));
+            close(TimerWheel::Handle(h));
+            ++n;
+        }
+        return n;
+    }
+
+    size_t symbols() const { return symbol_count; }
+    const std::vector<uint64_t>& interval_ns() const { return intervals; }
+
+    // bar still accumulating for (symbol, interval index), or nullptr
+    const Bar* current(uint32_t symbol, size_t interval) const {
+        const Slot& slot = slots[symbol * intervals.size() + interval];
+        return slot.active ? &slot.open : nullptr;
+    }
+
+    // completed bars retained in the ring (at most RingBars)
+    size_t history(uint32_t symbol, size_t interval) const {
+        uint64_t n = slots[symbol * intervals.size() + interval].completed;
+        return n < RingBars ? size_t(n) : RingBars;
+    }
+
+    // completed bar by age: 0 is the most recent; age < history()
+    const Bar& completed(uint32_t symbol, size_t interval, size_t age) const {
+        size_t h = symbol * intervals.size() + interval;
+        return rings[h * RingBars + ((slots[h].completed - 1 - age) & (RingBars - 1))];
+    }
+
+    // bars closed since construction, all symbols and intervals
+    uint64_t bars_closed() const { return closed; }
+};
+
+using BarAggregator = BasicBarAggregator<>;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "orderbook/bar_aggregator.h"
+#include "orderbook/bar_file.h"
+#include "orderbook/spsc_queue.h"
+
+// Runs a bar aggregator on its own thread (optionally pinned to one core),
+// fed through an SPSC ring so the publishing thread pays one copy and two
+// atomic operations per fill. Closed bars are appended to a columnar bar
+// file (bar_file.h) as they complete.
+//
+// publish() must only be called from one thread. The aggregator is owned by
+// the consumer thread; read it through aggregator() only after stop(). A
+// consumer runs once: stop() flushes every bar and finishes the file, so it
+// cannot be started again (reopening would truncate what it wrote).
+template<size_t RingBars = 512>
+class BasicBarConsumer {
+public:
+    static constexpr size_t kDrainBatch = 256;
+
+    BasicBarConsumer(size_t symbols, std::string output_path, int core = -1, size_t queue_capacity = 65536,
+                     std::vector<uint64_t> intervals_ns = {BasicBarAggregator<RingBars>::kSecond,
+                                                           BasicBarAggregator<RingBars>::kMinute})
+        : queue(queue_capacity), bars(symbols, std::move(intervals_ns)),
+          path(std::move(output_path)), cpu(core) {
+        bars.set_bar_sink(&closed);
+    }
+
+    ~BasicBarConsumer() { stop(); }
+
+    BasicBarConsumer(const BasicBarConsumer&) = delete;
+    BasicBarConsumer& operator=(const BasicBarConsumer&) = delete;
+
+    // open the output file and start the consumer thread; false if the
+    // file cannot be opened or the consumer has already been stopped
+    bool start() {
+        if (thread.joinable()) return true;
+        if (finished || !writer.open(path)) return false;
+        running.store(true, std::memory_order_relaxed);
+        thread = std::thread([this] { run(); });
+        pin();
+        return true;
+    }
+
+    // drain queued fills, close every open bar and finish the file
+    void stop() {
+        running.store(false, std::memory_order_release);
+        if (thread.joinable()) {
+            thread.join();
+            finished = true;
+        }
+    }
+
+    // producer side; false if the ring is full (the caller decides whether
+    // to spin or drop)
+    bool publish(const Fill& fill) {
+        return queue.push(fill);
+    }
+
+    uint64_t fills_consumed() const { return consumed.load(std::memory_order_relaxed); }
+    bool pinned() const { return pinned_to_cpu; }
+
+    const BasicBarAggregator<RingBars>& aggregator() const { return bars; }
+
+private:
+    void pin() {
+#if defined(__linux__)
+        if (cpu < 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pinned_to_cpu = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#endif
+    }
+
+    // pop up to kDrainBatch fills; returns the number applied
+    size_t drain() {
+        Fill fill;
+        size_t n = 0;
+        while (n < kDrainBatch && queue.pop(fill)) {
+            bars.on_fill(fill);
+            ++n;
+        }
+        if (n) consumed.fetch_add(n, std::memory_order_relaxed);
+        if (!closed.empty()) {
+            writer.write(closed);
+            closed.clear();
+        }
+        return n;
+    }
+
+    void run() {
+        while (running.load(std::memory_order_acquire)) {
+            if (!drain()) std::this_thread::yield();
+        }
+        while (drain()) {
+        }
+        bars.flush();
+        writer.write(closed);
+        closed.clear();
+        writer.close();
+    }
+
+    SpscQueue<Fill> queue;
+    BasicBarAggregator<RingBars> bars;
+    BarFileWriter writer;
+    std::vector<Bar> closed;
+    std::string path;
+    int cpu;
+    bool pinned_to_cpu = false;
+    bool finished = false;      // stopped after a run; the file is complete
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> consumed{0};
+    std::thread thread;
+};
+
+using BarConsumer = BasicBarConsumer<>;
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "orderbook/bar_aggregator.h"
+
+// Columnar bar file for research tools: a 32-byte header, then chunks of up
+// to chunk_rows bars stored column by column, so a reader that wants only
+// closes or volumes can seek past the rest.
+//
+//   char     magic[8]     "OBBARS01"
+//   uint32_t columns      kBarColumns
+//   uint32_t chunk_rows   rows per full chunk
+//   uint64_t rows         total bars (patched on close)
+//   uint64_t chunks       number of chunks (patched on close)
+//
+// Each chunk is a uint64_t row count n followed by the columns in Bar field
+// order: start_ns, interval_ns (u64), symbol, trades (u32), open, high, low,
+// close (f64), volume, buy_volume (u64), notional (f64), each n values.
+struct BarFileHeader {
+    char magic[8];
+    uint32_t columns;
+    uint32_t chunk_rows;
+    uint64_t rows;
+    uint64_t chunks;
+};
+
+static_assert(sizeof(BarFileHeader) == 32, "BarFileHeader is a file format header");
+
+constexpr char kBarFileMagic[8] = {'O', 'B', 'B', 'A', 'R', 'S', '0', '1'};
+constexpr uint32_t kBarColumns = 11;
+
+class BarFileWriter {
+public:
+    static constexpr uint32_t kChunkRows = 4096;
+
+    BarFileWriter() = default;
+    explicit BarFileWriter(const std::string& path) { open(path); }
+    ~BarFileWriter() { close(); }
+
+    BarFileWriter(const BarFileWriter&) = delete;
+    BarFileWriter& operator=(const BarFileWriter&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        rows = chunks = 0;
+        pending.clear();
+        pending.reserve(kChunkRows);
+        BarFileHeader header = make_header();
+        return std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    bool write(const Bar& bar) {
+        pending.push_back(bar);
+        return pending.size() < kChunkRows || flush_chunk();
+    }
+
+    bool write(const std::vector<Bar>& bars) {
+        bool ok = true;
+        for (const Bar& b : bars) ok = write(b) && ok;
+        return ok;
+    }
+
+    // flush the partial chunk and patch the totals into the header
+    bool close() {
+        if (!file) return true;
+        bool ok = pending.empty() || flush_chunk();
+        BarFileHeader header = make_header();
+        ok = std::fseek(file, 0, SEEK_SET) == 0 &&
+             std::fwrite(&header, sizeof(header), 1, file) == 1 && ok;
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    bool is_open() const { return file != nullptr; }
+    uint64_t size() const { return rows + pending.size(); }
+
+private:
+    BarFileHeader make_header() const {
+        BarFileHeader header{};
+        std::memcpy(header.magic, kBarFileMagic, sizeof(header.magic));
+        header.columns = kBarColumns;
+        header.chunk_rows = kChunkRows;
+        header.rows = rows;
+        header.chunks = chunks;
+        return header;
+    }
+
+    // gather one field of every pending bar and write it as a column
+    template<typename T, typename Get>
+    bool column(Get get) {
+        scratch.resize(pending.size() * sizeof(T));
+        T* out = reinterpret_cast<T*>(scratch.data());
+        for (size_t i = 0; i < pending.size(); ++i) out[i] = get(pending[i]);
+        return std::fwrite(scratch.data(), 1, scratch.size(), file) == scratch.size();
+    }
+
+    bool flush_chunk() {
+        uint64_t n = pending.size();
+        bool ok = std::fwrite(&n, sizeof(n), 1, file) == 1 &&
+                  column<uint64_t>([](const Bar& b) { return b.start_ns; }) &&
+                  column<uint64_t>([](const Bar& b) { return b.interval_ns; }) &&
+                  column<uint32_t>([](const Bar& b) { return b.symbol; }) &&
+                  column<uint32_t>([](const Bar& b) { return b.trades; }) &&
+                  column<double>([](const Bar& b) { return b.open; }) &&
+                  column<double>([](const Bar& b) { return b.high; }) &&
+                  column<double>([](const Bar& b) { return b.low; }) &&
+                  column<double>([](const Bar& b) { return b.close; }) &&
+                  column<uint64_t>([](const Bar& b) { return b.volume; }) &&
+                  column<uint64_t>([](const Bar& b) { return b.buy_volume; }) &&
+                  column<double>([](const Bar& b) { return b.notional; });
+        rows += n;
+        ++chunks;
+        pending.clear();
+        return ok;
+    }
+
+    FILE* file = nullptr;
+    uint64_t rows = 0;
+    uint64_t chunks = 0;
+    std::vector<Bar> pending;
+    std::vector<unsigned char> scratch;
+};
+
+// Reads a whole bar file back into row form (tests and small tools; research
+// readers map the columns directly).
+inline bool read_bar_file(const std::string& path, std::vector<Bar>& out) {
+    out.clear();
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    BarFileHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, kBarFileMagic, sizeof(kBarFileMagic)) == 0 &&
+              header.columns == kBarColumns;
+    if (ok) out.reserve(header.rows);
+
+    std::vector<unsigned char> scratch;
+    auto column = [&](auto member, size_t base, size_t n) {
+        using T = std::remove_reference_t<decltype(out[0].*member)>;
+        scratch.resize(n * sizeof(T));
+        if (std::fread(scratch.data(), 1, scratch.size(), file) != scratch.size()) return false;
+        const T* in = reinterpret_cast<const T*>(scratch.data());
+        for (size_t i = 0; i < n; ++i) out[base + i].*member = in[i];
+        return true;
+    };
+
+    for (uint64_t c = 0; ok && c < header.chunks; ++c) {
+        uint64_t n;
+        if (std::fread(&n, sizeof(n), 1, file) != 1 || n > header.chunk_rows) {
+            ok = false;
+            break;
+        }
+        size_t base = out.size();
+        out.resize(base + n);
+        ok = column(&Bar::start_ns, base, n) && column(&Bar::interval_ns, base, n) &&
+             column(&Bar::symbol, base, n) && column(&Bar::trades, base, n) &&
+             column(&Bar::open, base, n) && column(&Bar::high, base, n) &&
+             column(&Bar::low, base, n) && column(&Bar::close, base, n) &&
+             column(&Bar::volume, base, n) && column(&Bar::buy_volume, base, n) &&
+             column(&Bar::notional, base, n);
+    }
+
+    std::fclose(file);
+    return ok && out.size() == header.rows;
+}
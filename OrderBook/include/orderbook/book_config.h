@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "orderbook/book_side.h"
+#include "orderbook/direct_index.h"
+#include "orderbook/order_index.h"
+#include "orderbook/price.h"
+
+// Compile-time configuration for BasicOrderBook. Derive from DefaultConfig
+// and override what differs:
+//
+//   Price              price -> level key policy (price.h)
+//   Side<K, L, Bid>    side container for keys K and levels L (book_side.h)
+//   Index              order_id -> pool handle index
+//   kPoolBlockSize     bytes per order pool slab
+//   kExpectedOrders    resting orders to size the pool and index for up front
+//   kChecksum          maintain an incremental checksum of the resting orders
+//   kBranchlessLevels  link and unlink queue nodes and drop emptied levels
+//                      with conditional moves instead of branches
+
+// any price, tree levels, hashed ids: the general-purpose book
+struct DefaultConfig {
+    using Price = DoublePrice;
+
+    template<typename Key, typename Level, bool Bid>
+    using Side = MapSide<Key, Level, Bid>;
+
+    using Index = OrderIndex;
+
+    static constexpr size_t kPoolBlockSize = 8192;
+    static constexpr size_t kExpectedOrders = 0;
+    static constexpr bool kChecksum = false;
+    static constexpr bool kBranchlessLevels = false;
+};
+
+// fixed tick grid, array ladder of Levels ticks per side and a direct id
+// table: the futures-style book for instruments with a tight price band and
+// exchange-assigned dense ids
+template<int64_t TicksPerUnit, size_t Levels, uint64_t MaxIds>
+struct LadderConfig : DefaultConfig {
+    using Price = TickPrice<TicksPerUnit>;
+
+    template<typename Key, typename Level, bool Bid>
+    using Side = LadderSide<Key, Level, Bid, Levels>;
+
+    using Index = DirectOrderIndex<MaxIds>;
+
+    // a ladder level is a plain array slot, so level upkeep is all flag
+    // tests that random flow makes unpredictable
+    static constexpr bool kBranchlessLevels = true;
+};
+
+// any config plus the incremental book checksum (book_diff.h, diff tools);
+// off by default since it costs a hash per mutation
+template<typename Config>
+struct WithChecksum : Config {
+    static constexpr bool kChecksum = true;
+};
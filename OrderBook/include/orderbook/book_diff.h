@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "orderbook/order.h"
+
+// Minimal difference between two books' L2 and L3 state, for hunting down
+// where an optimized book diverges from the reference. Books are compared
+// by their exported levels and orders, so any two configs can be diffed.
+//
+// Only what differs is reported: levels whose aggregate quantity disagrees,
+// orders present in one book only or with different side/price/quantity,
+// and orders whose queue position among the orders both books hold at that
+// level differs (a missing order ahead in the queue is reported once, not
+// as a shift of everything behind it).
+//
+// A full diff walks both books; replay tools run it only when the cheap
+// get_checksum() comparison (WithChecksum configs) or a periodic check says
+// the books disagree.
+
+// aggregate quantity at one price in each book; 0 = no such level
+struct LevelDiff {
+    bool is_buy;
+    double price;
+    uint64_t quantity_a;
+    uint64_t quantity_b;
+};
+
+enum class OrderDiffKind : uint8_t {
+    OnlyInA,
+    OnlyInB,
+    Changed,        // side, price or quantity differ
+    QueuePosition,  // same order, different place in its level's FIFO
+};
+
+struct OrderDiff {
+    OrderDiffKind kind;
+    uint64_t order_id;
+    bool is_buy;            // side in a (b for OnlyInB)
+    double price_a, price_b;
+    uint64_t quantity_a, quantity_b;
+    size_t position_a, position_b;  // QueuePosition: rank among the shared orders
+};
+
+struct BookDiff {
+    std::vector<LevelDiff> levels;
+    std::vector<OrderDiff> orders;
+
+    bool empty() const { return levels.empty() && orders.empty(); }
+
+    void clear() {
+        levels.clear();
+        orders.clear();
+    }
+
+    void print(std::ostream& os) const {
+        for (const LevelDiff& l : levels) {
+            os << "  level " << (l.is_buy ? "bid " : "ask ") << l.price
+               << ": a=" << l.quantity_a << " b=" << l.quantity_b << "\n";
+        }
+        for (const OrderDiff& o : orders) {
+            os << "  order " << o.order_id << ": ";
+            switch (o.kind) {
+            case OrderDiffKind::OnlyInA:
+                os << "only in a (" << (o.is_buy ? "buy " : "sell ") << o.quantity_a << " @ " << o.price_a << ")";
+                break;
+            case OrderDiffKind::OnlyInB:
+                os << "only in b (" << (o.is_buy ? "buy " : "sell ") << o.quantity_b << " @ " << o.price_b << ")";
+                break;
+            case OrderDiffKind::Changed:
+                os << "a=" << o.quantity_a << " @ " << o.price_a << " b=" << o.quantity_b << " @ " << o.price_b;
+                break;
+            case OrderDiffKind::QueuePosition:
+                os << "queue position a=" << o.position_a << " b=" << o.position_b << " @ " << o.price_a;
+                break;
+            }
+            os << "\n";
+        }
+    }
+};
+
+// fill out with the differences between books a and b; returns out.empty()
+template<typename BookA, typename BookB>
+bool diff_books(const BookA& a, const BookB& b, BookDiff& out) {
+    out.clear();
+
+    // L2: merge both sides' full depth by price
+    std::vector<PriceLevel> bids_a, asks_a, bids_b, asks_b;
+    a.get_snapshot(std::max(a.get_bid_levels(), a.get_ask_levels()), bids_a, asks_a);
+    b.get_snapshot(std::max(b.get_bid_levels(), b.get_ask_levels()), bids_b, asks_b);
+    auto diff_side = [&](bool is_buy, const std::vector<PriceLevel>& la, const std::vector<PriceLevel>& lb) {
+        std::map<double, std::pair<uint64_t, uint64_t>> merged;
+        for (const PriceLevel& l : la) merged[l.price].first = l.total_quantity;
+        for (const PriceLevel& l : lb) merged[l.price].second = l.total_quantity;
+        auto emit = [&](const auto& entry) {
+            if (entry.second.first != entry.second.second) {
+                out.levels.push_back(LevelDiff{is_buy, entry.first, entry.second.first, entry.second.second});
+            }
+        };
+        // best price first, as the books list them
+        if (is_buy) {
+            for (auto it = merged.rbegin(); it != merged.rend(); ++it) emit(*it);
+        } else {
+            for (const auto& entry : merged) emit(entry);
+        }
+    };
+    diff_side(true, bids_a, bids_b);
+    diff_side(false, asks_a, asks_b);
+
+    // L3: match orders by id
+    std::vector<Order> orders_a, orders_b;
+    a.get_orders(orders_a);
+    b.get_orders(orders_b);
+    std::unordered_map<uint64_t, size_t> in_b;
+    in_b.reserve(orders_b.size());
+    for (size_t i = 0; i < orders_b.size(); ++i) in_b.emplace(orders_b[i].order_id, i);
+
+    auto same_place = [](const Order& x, const Order& y) {
+        return x.is_buy == y.is_buy && x.price == y.price;
+    };
+    auto diff_of = [](OrderDiffKind kind, const Order& x, const Order& y) {
+        return OrderDiff{kind, x.order_id, x.is_buy, x.price, y.price, x.quantity, y.quantity, 0, 0};
+    };
+
+    std::vector<bool> matched(orders_b.size(), false);
+    for (const Order& oa : orders_a) {
+        auto it = in_b.find(oa.order_id);
+        if (it == in_b.end()) {
+            out.orders.push_back(OrderDiff{OrderDiffKind::OnlyInA, oa.order_id, oa.is_buy,
+                                           oa.price, 0.0, oa.quantity, 0, 0, 0});
+            continue;
+        }
+        matched[it->second] = true;
+        const Order& ob = orders_b[it->second];
+        if (!same_place(oa, ob) || oa.quantity != ob.quantity) {
+            out.orders.push_back(diff_of(OrderDiffKind::Changed, oa, ob));
+        }
+    }
+    for (size_t i = 0; i < orders_b.size(); ++i) {
+        if (!matched[i]) {
+            const Order& ob = orders_b[i];
+            out.orders.push_back(OrderDiff{OrderDiffKind::OnlyInB, ob.order_id, ob.is_buy,
+                                           0.0, ob.price, 0, ob.quantity, 0, 0});
+        }
+    }
+
+    // queue priority, per level, over the orders both books hold there: keep
+    // the longest run that is in the same relative order in both books and
+    // report only the orders outside it, so one order jumping the queue is
+    // one diff rather than a shift of everything it passed
+    using LevelKey = std::pair<bool, double>;
+    std::map<LevelKey, std::vector<const Order*>> shared_a;   // in a's FIFO order
+    std::vector<bool> shared(orders_b.size(), false);
+    for (const Order& oa : orders_a) {
+        auto it = in_b.find(oa.order_id);
+        if (it != in_b.end() && same_place(oa, orders_b[it->second])) {
+            shared_a[LevelKey(oa.is_buy, oa.price)].push_back(&oa);
+            shared[it->second] = true;
+        }
+    }
+    std::unordered_map<uint64_t, size_t> rank_b;
+    std::map<LevelKey, size_t> next_rank;
+    for (size_t i = 0; i < orders_b.size(); ++i) {
+        if (shared[i]) {
+            const Order& ob = orders_b[i];
+            rank_b.emplace(ob.order_id, next_rank[LevelKey(ob.is_buy, ob.price)]++);
+        }
+    }
+
+    std::vector<size_t> tails, parent;
+    std::vector<bool> keep;
+    for (const auto& level : shared_a) {
+        const std::vector<const Order*>& queue = level.second;
+        // longest increasing subsequence of b-ranks, O(n log n)
+        tails.clear();
+        parent.assign(queue.size(), SIZE_MAX);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            size_t r = rank_b[queue[i]->order_id];
+            size_t lo = 0, hi = tails.size();
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (rank_b[queue[tails[mid]]->order_id] < r) lo = mid + 1; else hi = mid;
+            }
+            if (lo > 0) parent[i] = tails[lo - 1];
+            if (lo == tails.size()) tails.push_back(i); else tails[lo] = i;
+        }
+        keep.assign(queue.size(), false);
+        for (size_t i = tails.empty() ? SIZE_MAX : tails.back(); i != SIZE_MAX; i = parent[i]) keep[i] = true;
+
+        for (size_t i = 0; i < queue.size(); ++i) {
+            if (keep[i]) continue;
+            const Order& oa = *queue[i];
+            OrderDiff d = diff_of(OrderDiffKind::QueuePosition, oa, orders_b[in_b[oa.order_id]]);
+            d.position_a = i;
+            d.position_b = rank_b[oa.order_id];
+            out.orders.push_back(d);
+        }
+    }
+    return out.empty();
+}
+
+// Narrow a divergence found by a periodic full diff: given that the books
+// agree after the first `clean` events and disagree after the first `dirty`,
+// returns n in (clean, dirty] with diverged(n) && !diverged(n - 1), so event
+// n - 1 introduces a difference. Each probe is a fresh replay plus a full
+// diff, so this takes log2(dirty - clean) of them. It is the first
+// divergence only if differences persist once introduced; a queue-order slip
+// that a later cancel removes can hide an earlier one, which only a linear
+// scan of the range finds.
+template<typename Diverged>
+uint64_t bisect_divergence(uint64_t clean, uint64_t dirty, Diverged&& diverged) {
+    while (dirty - clean > 1) {
+        uint64_t mid = clean + (dirty - clean) / 2;
+        if (diverged(mid)) {
+            dirty = mid;
+        } else {
+            clean = mid;
+        }
+    }
+    return dirty;
+}
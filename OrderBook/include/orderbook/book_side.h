@@ -0,0 +1,183 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "orderbook/compiler.h"
+#include "orderbook/meta.h"
+
+// Side containers: price key -> Level, walked best price first (highest for
+// bids, lowest for asks). Interface used by BasicOrderBook:
+//
+//   accepts(key)   can this side hold a level at key
+//   level(key)     the level at key, created empty if missing (key accepted)
+//   find(key)      the level at key or nullptr
+//   erase(key)     drop the (now empty) level at key
+//   release(key)   drop the level at key if it has become empty
+//   walk(f)        f(key, level) best first until f returns false
+
+// balanced tree: any key, O(log n) per level lookup
+template<typename Key, typename Level, bool Bid>
+class MapSide {
+private:
+    using Compare = std::conditional_t<Bid, std::greater<Key>, std::less<Key>>;
+
+    std::map<Key, Level, Compare> levels;
+
+public:
+    bool accepts(Key) const { return true; }
+
+    Level& level(Key key) { return levels[key]; }
+
+    Level* find(Key key) {
+        auto it = levels.find(key);
+        return it == levels.end() ? nullptr : &it->second;
+    }
+
+    const Level* find(Key key) const {
+        auto it = levels.find(key);
+        return it == levels.end() ? nullptr : &it->second;
+    }
+
+    void erase(Key key) { levels.erase(key); }
+
+    void release(Key key) {
+        auto it = levels.find(key);
+        if (it != levels.end() && it->second.empty()) levels.erase(it);
+    }
+
+    template<typename F>
+    void walk(F&& f) const {
+        for (const auto& [key, level] : levels) {
+            if (!f(key, level)) return;
+        }
+    }
+
+    size_t size() const { return levels.size(); }
+    bool empty() const { return levels.empty(); }
+    void clear() { levels.clear(); }
+};
+
+// Fixed array of Levels consecutive ticks with an occupancy bitmap: O(1)
+// level lookup, best-first walks skip empty ticks 64 at a time. The window
+// is anchored so the first price lands mid-ladder and re-anchors whenever
+// the side empties; prices outside the window are not accepted.
+template<typename Key, typename Level, bool Bid, size_t Levels>
+class LadderSide {
+private:
+    static_assert(std::is_integral<Key>::value, "a ladder needs integral tick keys");
+    static_assert(Levels > 0 && Levels % 64 == 0, "ladder size must be a multiple of 64");
+
+    // slot i lives in bitmap word i >> kWordShift, bit i & kBitMask
+    static constexpr unsigned kWordShift = Log2<64>::value;
+    static constexpr size_t kBitMask = (size_t(1) << kWordShift) - 1;
+    static constexpr size_t kWords = Levels >> kWordShift;
+
+    std::vector<Level> levels;
+    std::array<uint64_t, kWords> occupied{};
+    Key base = 0;       // key of slot 0
+    size_t count = 0;
+
+    // offset of key from slot 0, subtracted in uint64_t so far-off keys
+    // (INT64_MIN from a NaN price) wrap instead of overflowing
+    inline uint64_t offset(Key key) const {
+        return static_cast<uint64_t>(key) - static_cast<uint64_t>(base);
+    }
+
+    inline Key key_at(size_t i) const {
+        return static_cast<Key>(static_cast<uint64_t>(base) + i);
+    }
+
+    // one subtract and one unsigned compare: keys below base wrap high
+    inline bool in_window(Key key) const {
+        return offset(key) < Levels;
+    }
+
+public:
+    static constexpr size_t kLevels = Levels;
+
+    LadderSide() : levels(Levels) {}
+
+    bool accepts(Key key) const { return count == 0 || in_window(key); }
+
+    // level(), find() and release() are branch-free: which way an occupancy
+    // test goes is close to random under real flow, so they select with
+    // masks (branchless_select) rather than guess
+
+    Level& level(Key key) {
+        Key anchor = static_cast<Key>(static_cast<uint64_t>(key) - Levels / 2);
+        base = branchless_select(count != 0, base, anchor);
+        size_t i = static_cast<size_t>(offset(key));
+        uint64_t& word = occupied[i >> kWordShift];
+        uint64_t bit = uint64_t(1) << (i & kBitMask);
+        count += !(word & bit);
+        word |= bit;
+        return levels[i];
+    }
+
+    Level* find(Key key) {
+        bool in = in_window(key);
+        size_t i = branchless_select(in, static_cast<size_t>(offset(key)), size_t(0));
+        bool hit = in & ((occupied[i >> kWordShift] >> (i & kBitMask)) & 1);
+        return branchless_select(hit, &levels[i], static_cast<Level*>(nullptr));
+    }
+
+    const Level* find(Key key) const {
+        return const_cast<LadderSide*>(this)->find(key);
+    }
+
+    void erase(Key key) {
+        size_t i = static_cast<size_t>(offset(key));
+        levels[i] = Level{};
+        occupied[i >> kWordShift] &= ~(uint64_t(1) << (i & kBitMask));
+        --count;
+    }
+
+    // an emptied level is already in its default state, so dropping it is
+    // clearing its bit - done under a mask of level.empty()
+    void release(Key key) {
+        size_t i = static_cast<size_t>(offset(key));
+        uint64_t drop = -uint64_t(levels[i].empty());
+        occupied[i >> kWordShift] &= ~((uint64_t(1) << (i & kBitMask)) & drop);
+        count -= size_t(drop & 1);
+    }
+
+    template<typename F>
+    void walk(F&& f) const {
+        if (Bid) {
+            for (size_t w = kWords; w-- > 0;) {
+                for (uint64_t bits = occupied[w]; bits;) {
+                    unsigned b = 63 - __builtin_clzll(bits);
+                    size_t i = (w << kWordShift) + b;
+                    if (!f(key_at(i), levels[i])) return;
+                    bits &= ~(uint64_t(1) << b);
+                }
+            }
+        } else {
+            for (size_t w = 0; w < kWords; ++w) {
+                for (uint64_t bits = occupied[w]; bits; bits &= bits - 1) {
+                    size_t i = (w << kWordShift) + __builtin_ctzll(bits);
+                    if (!f(key_at(i), levels[i])) return;
+                }
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        for (size_t w = 0; w < kWords; ++w) {
+            for (uint64_t bits = occupied[w]; bits; bits &= bits - 1) {
+                levels[(w << kWordShift) + __builtin_ctzll(bits)] = Level{};
+            }
+            occupied[w] = 0;
+        }
+        count = 0;
+    }
+};
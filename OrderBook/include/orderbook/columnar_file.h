@@ -0,0 +1,566 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ORDERBOOK_HAVE_MMAP 1
+#endif
+
+#include "orderbook/order_event.h"
+#include "orderbook/varint.h"
+
+// Read-only view of a whole file: mmap where available, else read into memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#if defined(ORDERBOOK_HAVE_MMAP)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        ::madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+        bytes = static_cast<const uint8_t*>(p);
+        length = size_t(st.st_size);
+#else
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        std::fseek(f, 0, SEEK_END);
+        long n = std::ftell(f);
+        std::fseek(f, 0, SEEK_SET);
+        if (n <= 0) {
+            std::fclose(f);
+            return false;
+        }
+        copy.resize(size_t(n));
+        bool ok = std::fread(copy.data(), 1, copy.size(), f) == copy.size();
+        std::fclose(f);
+        if (!ok) return false;
+        bytes = copy.data();
+        length = copy.size();
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(ORDERBOOK_HAVE_MMAP)
+        if (bytes) ::munmap(const_cast<uint8_t*>(bytes), length);
+#else
+        copy.clear();
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool is_open() const { return bytes != nullptr; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+#if !defined(ORDERBOOK_HAVE_MMAP)
+    std::vector<uint8_t> copy;
+#endif
+};
+
+// Columnar, chunked, delta-encoded event file. Where a replay file stores
+// 48-byte OrderEvent rows, this stores each field as its own compressed
+// column inside chunks of up to kChunkEvents events, so a 2M-event day
+// shrinks several-fold and a time seek touches one chunk.
+//
+//   ColumnarHeader (64 bytes), patched on close
+//   chunk 0 .. chunk n-1
+//   ChunkIndexEntry[n]         at header.index_offset
+//
+// A chunk is a ChunkHeader followed by its columns back to back (events
+// chunks and snapshot chunks alike):
+//
+//   flags      1 byte/event: type | is_buy << 2 | raw price << 3 | expiry << 4
+//   timestamp  delta-of-delta vs the previous event, zigzag varint
+//   order_id   delta vs the previous event, zigzag varint
+//   price      Add/Amend/Execute: delta in ticks vs the previous price, zigzag varint
+//   quantity   Add/Amend/Execute: varint
+//   expiry     Add with expiry: expiry - timestamp, zigzag varint
+//   owner      Add: varint
+//   raw price  Add/Amend/Execute prices off the tick grid: 8-byte doubles
+//
+// Chunks are padded to 8 bytes. Every delta restarts at each chunk
+// (first_ts is in the chunk header), so chunks decode independently. Fields
+// an event type does not use (a Cancel's price, an Amend's owner) decode as
+// zero, as OrderEvent's factories set them. Prices are stored as ticks when
+// double(ticks) / ticks_per_unit reproduces them exactly (the TickPrice
+// conversion), otherwise raw, so prices are lossless.
+//
+// Snapshot chunks embed the whole book (L3, in FIFO order) as Add events
+// with each order's own timestamp; they hold the state after every event
+// chunk before them, so a replay can start from the nearest one instead of
+// the open. They may exceed chunk_events and do not count in events.
+struct ColumnarHeader {
+    char magic[8];
+    uint32_t ticks_per_unit;
+    uint32_t chunk_events;      // capacity of a full chunk
+    uint64_t events;
+    uint64_t chunks;
+    uint64_t index_offset;
+    uint64_t snapshots;         // Snapshot chunks among the chunks
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(ColumnarHeader) == 64, "ColumnarHeader is a file format header");
+
+enum class ChunkKind : uint32_t {
+    Events = 0,
+    Snapshot = 1,       // resting orders as Add events, index first_ts = last_ts = snapshot time
+};
+
+struct ChunkIndexEntry {
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint64_t offset;            // of the ChunkHeader from file start
+    uint32_t count;
+    ChunkKind kind;
+};
+
+static_assert(sizeof(ChunkIndexEntry) == 32, "ChunkIndexEntry is a file format record");
+
+struct ChunkHeader {
+    static constexpr size_t kColumns = 8;
+
+    uint32_t count;
+    ChunkKind kind;
+    uint64_t first_ts;
+    uint32_t column_bytes[kColumns];
+};
+
+static_assert(sizeof(ChunkHeader) == 48, "ChunkHeader is a file format header");
+
+constexpr char kColumnarMagic[8] = {'O', 'B', 'C', 'O', 'L', 'S', '0', '1'};
+
+class ColumnarWriter {
+public:
+    static constexpr uint32_t kChunkEvents = 4096;
+
+    ColumnarWriter() = default;
+    explicit ColumnarWriter(const std::string& path, uint32_t ticks_per_unit = 100) {
+        open(path, ticks_per_unit);
+    }
+    ~ColumnarWriter() { close(); }
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool open(const std::string& path, uint32_t ticks_per_unit = 100) {
+        close();
+        if (ticks_per_unit == 0) return false;
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        tpu = ticks_per_unit;
+        events = 0;
+        snapshots = 0;
+        offset = sizeof(ColumnarHeader);
+        index.clear();
+        pending.clear();
+        pending.reserve(kChunkEvents);
+        ColumnarHeader header = make_header();
+        return std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    // events should arrive in timestamp order for the time index to be useful
+    bool write(const OrderEvent& ev) {
+        pending.push_back(ev);
+        return pending.size() < kChunkEvents || flush_chunk();
+    }
+
+    bool write(const OrderEvent* evs, size_t n) {
+        bool ok = true;
+        for (size_t i = 0; i < n; ++i) ok = write(evs[i]) && ok;
+        return ok;
+    }
+
+    // embed the book as of ts (BasicOrderBook::get_orders(): FIFO order)
+    // after the events written so far; the partial event chunk is flushed
+    // first so the snapshot sits at its place in the stream
+    bool write_snapshot(uint64_t ts, const std::vector<Order>& orders) {
+        bool ok = pending.empty() || flush_chunk();
+        snapshot.clear();
+        snapshot.reserve(orders.size());
+        for (const Order& o : orders) snapshot.push_back(OrderEvent::add(o));
+        ok = write_chunk(snapshot.data(), snapshot.size(), ChunkKind::Snapshot, ts, ts) && ok;
+        ++snapshots;
+        return ok;
+    }
+
+    // flush the partial chunk, append the index and patch the header
+    bool close() {
+        if (!file) return true;
+        bool ok = pending.empty() || flush_chunk();
+        ColumnarHeader header = make_header();
+        header.index_offset = offset;
+        ok = (index.empty() ||
+              std::fwrite(index.data(), sizeof(ChunkIndexEntry), index.size(), file) == index.size()) && ok;
+        ok = std::fseek(file, 0, SEEK_SET) == 0 &&
+             std::fwrite(&header, sizeof(header), 1, file) == 1 && ok;
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    bool is_open() const { return file != nullptr; }
+    uint64_t size() const { return events + pending.size(); }
+
+    // bytes written so far (chunks only; the index is added on close)
+    uint64_t bytes_written() const { return offset; }
+
+private:
+    enum Column { Flags, Timestamp, OrderId, PriceTicks, Quantity, Expiry, Owner, RawPrice };
+
+    ColumnarHeader make_header() const {
+        ColumnarHeader header{};
+        std::memcpy(header.magic, kColumnarMagic, sizeof(header.magic));
+        header.ticks_per_unit = tpu;
+        header.chunk_events = kChunkEvents;
+        header.events = events;
+        header.chunks = index.size();
+        header.snapshots = snapshots;
+        return header;
+    }
+
+    bool flush_chunk() {
+        bool ok = write_chunk(pending.data(), pending.size(), ChunkKind::Events,
+                              pending.front().timestamp_ns, pending.back().timestamp_ns);
+        events += pending.size();
+        pending.clear();
+        return ok;
+    }
+
+    // encode n events as one chunk; the index records [first_ts, last_ts]
+    bool write_chunk(const OrderEvent* evs, size_t n, ChunkKind kind, uint64_t first_ts, uint64_t last_ts) {
+        for (auto& c : columns) c.clear();
+
+        uint64_t base_ts = n ? evs[0].timestamp_ns : first_ts;
+        uint64_t prev_ts = base_ts;
+        int64_t prev_delta = 0;
+        uint64_t prev_id = 0;
+        int64_t prev_ticks = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const OrderEvent& ev = evs[i];
+            bool priced = ev.type != EventType::Cancel;
+            int64_t ticks = priced ? std::llround(ev.price * double(tpu)) : 0;
+            bool raw = priced && double(ticks) / double(tpu) != ev.price;
+            bool has_expiry = ev.type == EventType::Add && ev.expiry_ns != 0;
+
+            columns[Flags].push_back(uint8_t(uint8_t(ev.type) | ev.is_buy << 2 | raw << 3 | has_expiry << 4));
+
+            int64_t delta = int64_t(ev.timestamp_ns - prev_ts);
+            put_varint(columns[Timestamp], zigzag_encode(delta - prev_delta));
+            prev_delta = delta;
+            prev_ts = ev.timestamp_ns;
+
+            put_varint(columns[OrderId], zigzag_encode(int64_t(ev.order_id - prev_id)));
+            prev_id = ev.order_id;
+
+            if (priced) {
+                if (raw) {
+                    const uint8_t* b = reinterpret_cast<const uint8_t*>(&ev.price);
+                    columns[RawPrice].insert(columns[RawPrice].end(), b, b + sizeof(double));
+                } else {
+                    put_varint(columns[PriceTicks], zigzag_encode(ticks - prev_ticks));
+                    prev_ticks = ticks;
+                }
+                put_varint(columns[Quantity], ev.quantity);
+            }
+            if (has_expiry) {
+                put_varint(columns[Expiry], zigzag_encode(int64_t(ev.expiry_ns - ev.timestamp_ns)));
+            }
+            if (ev.type == EventType::Add) {
+                put_varint(columns[Owner], ev.owner);
+            }
+        }
+
+        ChunkHeader chunk{};
+        chunk.count = uint32_t(n);
+        chunk.kind = kind;
+        chunk.first_ts = base_ts;
+        size_t total = sizeof(chunk);
+        for (size_t c = 0; c < ChunkHeader::kColumns; ++c) {
+            chunk.column_bytes[c] = uint32_t(columns[c].size());
+            total += columns[c].size();
+        }
+
+        // pad to 8 bytes so chunk headers and the index stay aligned in the map
+        static const uint8_t zeros[8] = {};
+        size_t pad = (8 - total % 8) % 8;
+        total += pad;
+
+        bool ok = std::fwrite(&chunk, sizeof(chunk), 1, file) == 1;
+        for (const auto& c : columns) {
+            ok = ok && (c.empty() || std::fwrite(c.data(), 1, c.size(), file) == c.size());
+        }
+        ok = ok && (pad == 0 || std::fwrite(zeros, 1, pad, file) == pad);
+
+        index.push_back(ChunkIndexEntry{first_ts, last_ts, offset, chunk.count, kind});
+        offset += total;
+        return ok;
+    }
+
+    FILE* file = nullptr;
+    uint32_t tpu = 100;
+    uint64_t events = 0;
+    uint64_t snapshots = 0;
+    uint64_t offset = 0;
+    std::vector<OrderEvent> pending;
+    std::vector<OrderEvent> snapshot;
+    std::vector<ChunkIndexEntry> index;
+    std::vector<uint8_t> columns[ChunkHeader::kColumns];
+};
+
+// Decodes a mapped columnar file chunk by chunk. The index is read in
+// place, so opening a file costs one mmap and a header check regardless of
+// its length.
+class ColumnarReader {
+public:
+    ColumnarReader() = default;
+    explicit ColumnarReader(const std::string& path) { open(path); }
+
+    bool open(const std::string& path) {
+        header = nullptr;
+        entries = nullptr;
+        if (!file.open(path) || file.size() < sizeof(ColumnarHeader)) return false;
+
+        const ColumnarHeader* h = reinterpret_cast<const ColumnarHeader*>(file.data());
+        if (std::memcmp(h->magic, kColumnarMagic, sizeof(kColumnarMagic)) != 0 || h->ticks_per_unit == 0 ||
+            h->index_offset > file.size() ||
+            h->chunks > (file.size() - h->index_offset) / sizeof(ChunkIndexEntry)) {
+            file.close();
+            return false;
+        }
+        header = h;
+        entries = reinterpret_cast<const ChunkIndexEntry*>(file.data() + h->index_offset);
+        return true;
+    }
+
+    bool is_open() const { return header != nullptr; }
+    uint64_t size() const { return header ? header->events : 0; }
+    size_t chunks() const { return header ? size_t(header->chunks) : 0; }
+    size_t snapshots() const { return header ? size_t(header->snapshots) : 0; }
+    uint32_t chunk_capacity() const { return header ? header->chunk_events : 0; }
+    uint32_t ticks_per_unit() const { return header ? header->ticks_per_unit : 0; }
+    size_t file_bytes() const { return file.size(); }
+    const ChunkIndexEntry& chunk(size_t i) const { return entries[i]; }
+
+    // first chunk that may hold events at or after ts (chunks() if none);
+    // may be a snapshot chunk
+    size_t find_chunk(uint64_t ts) const {
+        const ChunkIndexEntry* end = entries + chunks();
+        const ChunkIndexEntry* it = std::lower_bound(entries, end, ts,
+                                                     [](const ChunkIndexEntry& e, uint64_t t) {
+                                                         return e.last_ts < t;
+                                                     });
+        return size_t(it - entries);
+    }
+
+    // last snapshot taken strictly before ts (chunks() if none): it holds no
+    // event at or after ts
+    size_t find_snapshot(uint64_t ts) const {
+        size_t i = find_chunk(ts);
+        while (i-- > 0) {
+            if (entries[i].kind == ChunkKind::Snapshot && entries[i].first_ts < ts) return i;
+        }
+        return chunks();
+    }
+
+    // decode events chunk i into out (room for chunk_capacity() events);
+    // returns the event count, 0 for a snapshot or corrupt chunk
+    size_t decode(size_t i, OrderEvent* out) const {
+        if (entries[i].kind != ChunkKind::Events || entries[i].count > header->chunk_events) return 0;
+        return decode_chunk(entries[i], out) ? entries[i].count : 0;
+    }
+
+    // resting orders of snapshot chunk i in FIFO order
+    bool decode_snapshot(size_t i, std::vector<Order>& out) const {
+        out.clear();
+        if (entries[i].kind != ChunkKind::Snapshot) return false;
+        std::vector<OrderEvent> adds(entries[i].count);
+        if (!decode_chunk(entries[i], adds.data())) return false;
+        out.reserve(adds.size());
+        for (const OrderEvent& ev : adds) out.push_back(ev.to_order());
+        return true;
+    }
+
+    // decode every events chunk in order; returns false on a corrupt file
+    bool read_all(std::vector<OrderEvent>& out) const {
+        out.resize(size_t(size()));
+        size_t n = 0;
+        for (size_t i = 0; i < chunks(); ++i) {
+            if (entries[i].kind != ChunkKind::Events) continue;
+            if (n + entries[i].count > out.size()) return false;
+            size_t got = decode(i, out.data() + n);
+            if (got != entries[i].count) return false;
+            n += got;
+        }
+        return n == out.size();
+    }
+
+    static bool read_all(const std::string& path, std::vector<OrderEvent>& out) {
+        ColumnarReader reader;
+        return reader.open(path) && reader.read_all(out);
+    }
+
+private:
+    // decode the chunk behind e into out (room for e.count events)
+    bool decode_chunk(const ChunkIndexEntry& e, OrderEvent* out) const {
+        if (e.offset + sizeof(ChunkHeader) > header->index_offset) return false;
+        const ChunkHeader* chunk = reinterpret_cast<const ChunkHeader*>(file.data() + e.offset);
+        if (chunk->kind != e.kind || chunk->count != e.count || chunk->column_bytes[0] != chunk->count) {
+            return false;
+        }
+
+        // column cursors; files are trusted to come from ColumnarWriter, and
+        // a column that decodes to the wrong length is caught by the end
+        // check below
+        const uint8_t* col[ChunkHeader::kColumns];
+        const uint8_t* end[ChunkHeader::kColumns];
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(chunk + 1);
+        for (size_t c = 0; c < ChunkHeader::kColumns; ++c) {
+            col[c] = p;
+            p += chunk->column_bytes[c];
+            end[c] = p;
+        }
+        if (p > file.data() + header->index_offset) return false;
+
+        const double tpu = double(header->ticks_per_unit);
+        uint64_t ts = chunk->first_ts;
+        int64_t delta = 0;
+        uint64_t id = 0;
+        int64_t ticks = 0;
+        for (uint32_t k = 0; k < chunk->count; ++k) {
+            OrderEvent& ev = out[k];
+            uint8_t flags = *col[0]++;
+            ev.type = EventType(flags & 3);
+            ev.is_buy = (flags >> 2) & 1;
+            ev.reserved[0] = ev.reserved[1] = 0;
+
+            delta += zigzag_decode(get_varint(col[1]));
+            ts += uint64_t(delta);
+            ev.timestamp_ns = ts;
+            id += uint64_t(zigzag_decode(get_varint(col[2])));
+            ev.order_id = id;
+
+            ev.price = 0.0;
+            ev.quantity = 0;
+            if (ev.type != EventType::Cancel) {
+                if (flags & 8) {
+                    std::memcpy(&ev.price, col[7], sizeof(double));
+                    col[7] += sizeof(double);
+                } else {
+                    ticks += zigzag_decode(get_varint(col[3]));
+                    ev.price = double(ticks) / tpu;
+                }
+                ev.quantity = get_varint(col[4]);
+            }
+            ev.expiry_ns = (flags & 16) ? ts + uint64_t(zigzag_decode(get_varint(col[5]))) : 0;
+            ev.owner = ev.type == EventType::Add ? uint32_t(get_varint(col[6])) : 0;
+        }
+
+        for (size_t c = 0; c < ChunkHeader::kColumns; ++c) {
+            if (col[c] != end[c]) return false;
+        }
+        return true;
+    }
+
+    MappedFile file;
+    const ColumnarHeader* header = nullptr;
+    const ChunkIndexEntry* entries = nullptr;
+};
+
+// Sequential replay over a columnar file that can start mid-session: seek()
+// rebuilds a book from the nearest earlier snapshot plus the events between
+// it and the target, then next() hands out the remaining events a chunk at
+// a time. With snapshots every N events a warm start replays at most N.
+class ColumnarCursor {
+public:
+    explicit ColumnarCursor(const ColumnarReader& r) : reader(r), buffer(r.chunk_capacity()) {}
+
+    // bring an empty book to its state just before the first event at or
+    // after ts, applying events the way the replay loop does (expire, then
+    // apply); returns the number of events replayed after the snapshot
+    template<typename Book>
+    uint64_t seek(Book& book, uint64_t ts) {
+        next_chunk = 0;
+        pos = count = 0;
+        size_t snap = reader.find_snapshot(ts);
+        if (snap < reader.chunks() && reader.decode_snapshot(snap, orders)) {
+            for (const Order& o : orders) book.restore_order(o);
+            next_chunk = snap + 1;
+        }
+
+        uint64_t replayed = 0;
+        while (pos < count || load()) {
+            for (; pos < count && buffer[pos].timestamp_ns < ts; ++pos, ++replayed) {
+                book.expire_orders(buffer[pos].timestamp_ns);
+                book.apply(buffer[pos]);
+            }
+            if (pos < count) break;
+        }
+        return replayed;
+    }
+
+    // next block of events from the current position; nullptr at the end
+    const OrderEvent* next(size_t& n) {
+        while (pos == count) {
+            if (!load()) {
+                n = 0;
+                return nullptr;
+            }
+        }
+        n = count - pos;
+        const OrderEvent* block = buffer.data() + pos;
+        pos = count;
+        return block;
+    }
+
+private:
+    // decode the next events chunk into the buffer
+    bool load() {
+        while (next_chunk < reader.chunks()) {
+            size_t i = next_chunk++;
+            if (reader.chunk(i).kind != ChunkKind::Events) continue;
+            count = reader.decode(i, buffer.data());
+            pos = 0;
+            return true;
+        }
+        return false;
+    }
+
+    const ColumnarReader& reader;
+    std::vector<OrderEvent> buffer;
+    std::vector<Order> orders;
+    size_t next_chunk = 0;
+    size_t pos = 0;
+    size_t count = 0;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+// Branch hints and cold-path markers (same idea as L9/branches.cpp).
+//
+// OB_LIKELY / OB_UNLIKELY are placed only where replaying a day of flow
+// showed a branch going one way >= 90% of the time. Define
+// ORDERBOOK_NO_BRANCH_HINTS to compile them out for before/after runs.
+//
+// OB_COLD moves a function out of line into .text.unlikely so rejects and
+// invariant failures do not take up space in the hot paths' I-cache.
+
+#if defined(__GNUC__) && !defined(ORDERBOOK_NO_BRANCH_HINTS)
+#define OB_LIKELY(x)   __builtin_expect(!!(x), 1)
+#define OB_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define OB_LIKELY(x)   (x)
+#define OB_UNLIKELY(x) (x)
+#endif
+
+#if defined(__GNUC__) && !defined(ORDERBOOK_NO_BRANCH_HINTS)
+#define OB_COLD __attribute__((cold, noinline))
+#else
+#define OB_COLD
+#endif
+
+#include <cstdint>
+#include <type_traits>
+
+// c ? a : b for integers and pointers, computed with a mask. GCC turns a
+// plain ?: whose operands it cannot prove safe to load into a jump; where
+// the condition is a coin flip under real flow (book_side.h, the FIFO
+// links in order_book.h) this keeps it a data dependency instead
+template<typename T>
+inline T branchless_select(bool c, T a, T b) {
+    static_assert(std::is_integral<T>::value, "integers and pointers only");
+    using U = std::make_unsigned_t<T>;
+    U mask = U(0) - U(c);
+    return T((U(a) & mask) | (U(b) & ~mask));
+}
+
+template<typename T>
+inline T* branchless_select(bool c, T* a, T* b) {
+    return reinterpret_cast<T*>(branchless_select(c, reinterpret_cast<uintptr_t>(a), reinterpret_cast<uintptr_t>(b)));
+}
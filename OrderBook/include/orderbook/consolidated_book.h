@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "orderbook/book_config.h"
+#include "orderbook/compiler.h"
+#include "orderbook/order.h"
+
+// Consolidated (NBBO) view of one symbol across up to kMaxVenues venues.
+// Each venue's book feeds its LevelDeltas (BasicOrderBook::set_delta_sink)
+// into apply(venue, delta); a consolidated level keeps per-venue quantities
+// plus a bitmask of the venues quoting it, so an update is one level lookup
+// and a few stores - snapshots are never re-merged. The best level on each
+// side is the side container's first, and best_venues() reads its mask.
+//
+// Levels use the same Price / Side policies as the book (book_config.h):
+// the default tree, or a LadderConfig for O(1) level lookup.
+template<typename Config = DefaultConfig>
+class BasicConsolidatedBook {
+public:
+    static constexpr size_t kMaxVenues = 16;
+
+    using Price = typename Config::Price;
+    using PriceKey = typename Price::Key;
+
+    struct Level {
+        uint64_t total_quantity = 0;
+        uint32_t venue_mask = 0;        // bit v set while venue v quotes here
+        std::array<uint64_t, kMaxVenues> venue_quantity{};
+    };
+
+private:
+    using BidSide = typename Config::template Side<PriceKey, Level, true>;
+    using AskSide = typename Config::template Side<PriceKey, Level, false>;
+
+    BidSide bids;
+    AskSide asks;
+
+    template<typename Side>
+    static bool apply_side(Side& side, size_t venue, PriceKey key, uint64_t quantity) {
+        uint32_t bit = uint32_t(1) << venue;
+        if (quantity == 0) {
+            Level* level = side.find(key);
+            if (!level || !(level->venue_mask & bit)) {
+                return false;
+            }
+            level->total_quantity -= level->venue_quantity[venue];
+            level->venue_quantity[venue] = 0;
+            level->venue_mask &= ~bit;
+            if (level->venue_mask == 0) {
+                side.erase(key);
+            }
+            return true;
+        }
+
+        if (OB_UNLIKELY(!side.accepts(key))) {
+            return false;
+        }
+        Level& level = side.level(key);
+        level.total_quantity = level.total_quantity - level.venue_quantity[venue] + quantity;
+        level.venue_quantity[venue] = quantity;
+        level.venue_mask |= bit;
+        return true;
+    }
+
+    template<typename Side>
+    static const Level* best_of(const Side& side, PriceKey& key) {
+        const Level* best = nullptr;
+        side.walk([&](PriceKey k, const Level& level) {
+            key = k;
+            best = &level;
+            return false;
+        });
+        return best;
+    }
+
+public:
+    // fold one venue level change in; false for an unknown venue, a removal
+    // of a level the venue does not quote, or a price outside a ladder
+    bool apply(size_t venue, const LevelDelta& delta) {
+        if (OB_UNLIKELY(venue >= kMaxVenues)) {
+            return false;
+        }
+        PriceKey key = Price::to_key(delta.price);
+        return delta.is_buy ? apply_side(bids, venue, key, delta.quantity)
+                            : apply_side(asks, venue, key, delta.quantity);
+    }
+
+    void apply(size_t venue, const std::vector<LevelDelta>& deltas) {
+        for (const LevelDelta& d : deltas) apply(venue, d);
+    }
+
+    // drop everything one venue quotes (venue disconnect)
+    void clear_venue(size_t venue) {
+        std::vector<LevelDelta> removals;
+        auto collect = [&](const auto& side, bool is_buy) {
+            side.walk([&](PriceKey key, const Level& level) {
+                if (level.venue_mask & (uint32_t(1) << venue)) {
+                    removals.push_back(LevelDelta{Price::to_price(key), 0, is_buy});
+                }
+                return true;
+            });
+        };
+        collect(bids, true);
+        collect(asks, false);
+        apply(venue, removals);
+    }
+
+    // national best bid and offer (quantity 0 for an empty side)
+    TopOfBook get_top() const {
+        TopOfBook top;
+        PriceKey key;
+        if (const Level* b = best_of(bids, key)) top.bid = PriceLevel(Price::to_price(key), b->total_quantity);
+        if (const Level* a = best_of(asks, key)) top.ask = PriceLevel(Price::to_price(key), a->total_quantity);
+        return top;
+    }
+
+    // venues quoting the best price on one side, as a bitmask
+    uint32_t best_venues(bool is_buy) const {
+        PriceKey key;
+        const Level* best = is_buy ? best_of(bids, key) : best_of(asks, key);
+        return best ? best->venue_mask : 0;
+    }
+
+    // one venue's quantity at a consolidated price
+    uint64_t venue_quantity(bool is_buy, double price, size_t venue) const {
+        PriceKey key = Price::to_key(price);
+        const Level* level = is_buy ? bids.find(key) : asks.find(key);
+        return level && venue < kMaxVenues ? level->venue_quantity[venue] : 0;
+    }
+
+    // f(price, level) best first until f returns false
+    template<typename F>
+    void walk(bool is_buy, F&& f) const {
+        auto visit = [&](PriceKey key, const Level& level) { return f(Price::to_price(key), level); };
+        if (is_buy) {
+            bids.walk(visit);
+        } else {
+            asks.walk(visit);
+        }
+    }
+
+    void get_snapshot(size_t depth, std::vector<PriceLevel>& bids_out, std::vector<PriceLevel>& asks_out) const {
+        bids_out.clear();
+        asks_out.clear();
+        if (depth == 0) return;
+        auto top = [depth](const auto& side, std::vector<PriceLevel>& out) {
+            side.walk([&](PriceKey key, const Level& level) {
+                out.emplace_back(Price::to_price(key), level.total_quantity);
+                return out.size() < depth;
+            });
+        };
+        top(bids, bids_out);
+        top(asks, asks_out);
+    }
+
+    size_t get_bid_levels() const { return bids.size(); }
+    size_t get_ask_levels() const { return asks.size(); }
+};
+
+using ConsolidatedBook = BasicConsolidatedBook<DefaultConfig>;
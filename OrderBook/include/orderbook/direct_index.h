@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "orderbook/compiler.h"
+
+// order_id -> pool handle as a flat array, for venues that assign dense ids
+// below a known bound. One load per lookup and no hashing, at 4 bytes per
+// possible id. Ids >= MaxIds are rejected on insert. Same interface as
+// OrderIndex (key_of is accepted and ignored) so the book can take either.
+template<uint64_t MaxIds>
+class DirectOrderIndex {
+private:
+    static_assert(MaxIds > 0 && MaxIds < UINT32_MAX, "id bound must fit the slot table");
+
+    std::vector<uint32_t> slots;
+    size_t count = 0;
+
+public:
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+    static constexpr uint64_t kMaxIds = MaxIds;
+
+    DirectOrderIndex() : slots(MaxIds, kInvalid) {}
+
+    void reserve(size_t) {}
+
+    template<typename KeyOf>
+    inline uint32_t find(uint64_t order_id, KeyOf&&) const {
+        return OB_LIKELY(order_id < MaxIds) ? slots[order_id] : kInvalid;
+    }
+
+    inline void prefetch(uint64_t order_id) const {
+        if (OB_LIKELY(order_id < MaxIds)) __builtin_prefetch(&slots[order_id]);
+    }
+
+    inline uint32_t hint(uint64_t order_id) const {
+        return OB_LIKELY(order_id < MaxIds) ? slots[order_id] : kInvalid;
+    }
+
+    // false if order_id is already present or out of range
+    template<typename KeyOf>
+    inline bool insert(uint64_t order_id, uint32_t slot, KeyOf&&) {
+        if (OB_UNLIKELY(order_id >= MaxIds || slots[order_id] != kInvalid)) return false;
+        slots[order_id] = slot;
+        ++count;
+        return true;
+    }
+
+    template<typename KeyOf>
+    inline bool erase(uint64_t order_id, KeyOf&&) {
+        if (order_id >= MaxIds || slots[order_id] == kInvalid) return false;
+        slots[order_id] = kInvalid;
+        --count;
+        return true;
+    }
+
+    void clear() {
+        std::fill(slots.begin(), slots.end(), kInvalid);
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t bucket_count() const { return slots.size(); }
+    size_t memory_bytes() const { return slots.size() * sizeof(uint32_t); }
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "orderbook/columnar_file.h"
+#include "orderbook/compiler.h"
+#include "orderbook/order_event.h"
+#include "orderbook/replay_file.h"
+
+// K-way merge of time-sorted event streams (one per venue feed) into one
+// timestamp-ordered stream, for consolidated backtests. Inputs are spans of
+// events already in memory, row replay files mapped in place, or columnar
+// files decoded a chunk at a time into a per-stream buffer.
+//
+// Selection is a loser tree: each internal node holds the stream that lost
+// the match played there, the root slot holds the overall winner. Handing
+// out an event replays one leaf-to-root path: log2(k) compares of
+// timestamps cached in the nodes, no heap sift-down, no branches on the
+// compare. Equal timestamps come out lowest stream first, so a merge is
+// deterministic.
+//
+// Streams are added and the tree built up front (start() and the columnar
+// cursors own every buffer); next() and drain() allocate nothing.
+class EventMerger {
+public:
+    // timestamp of an exhausted stream (an event stamped UINT64_MAX ends its stream)
+    static constexpr uint64_t kDone = UINT64_MAX;
+
+    EventMerger() = default;
+
+    EventMerger(const EventMerger&) = delete;
+    EventMerger& operator=(const EventMerger&) = delete;
+
+    // a time-sorted span the caller keeps alive; returns its stream number
+    uint32_t add_stream(const OrderEvent* events, size_t n) {
+        streams.push_back(Stream{events, events + n, nullptr});
+        return uint32_t(streams.size() - 1);
+    }
+
+    // a columnar file, decoded chunk by chunk; the reader must outlive the merge
+    uint32_t add_stream(const ColumnarReader& reader) {
+        cursors.push_back(std::make_unique<ColumnarCursor>(reader));
+        streams.push_back(Stream{nullptr, nullptr, cursors.back().get()});
+        return uint32_t(streams.size() - 1);
+    }
+
+    // a columnar or row replay file, opened and owned by the merger; row
+    // files are mapped and merged in place
+    bool add_file(const std::string& path) {
+        auto columnar = std::make_unique<ColumnarReader>();
+        if (columnar->open(path)) {
+            add_stream(*columnar);
+            readers.push_back(std::move(columnar));
+            return true;
+        }
+
+        auto mapped = std::make_unique<MappedFile>();
+        if (!mapped->open(path) || mapped->size() < sizeof(ReplayHeader)) return false;
+        ReplayHeader header;
+        std::memcpy(&header, mapped->data(), sizeof(header));
+        if (std::memcmp(header.magic, kReplayMagic, sizeof(kReplayMagic)) != 0 ||
+            header.record_size != sizeof(OrderEvent)) {
+            return false;
+        }
+        size_t n = (mapped->size() - sizeof(ReplayHeader)) / sizeof(OrderEvent);
+        if (header.count < n) n = size_t(header.count);
+        add_stream(reinterpret_cast<const OrderEvent*>(mapped->data() + sizeof(ReplayHeader)), n);
+        files.push_back(std::move(mapped));
+        return true;
+    }
+
+    size_t size() const { return streams.size(); }
+
+    // load every stream's first event and play the initial tournament; call
+    // once after adding streams
+    void start() {
+        leaves = 1;
+        while (leaves < streams.size()) leaves <<= 1;
+        tree.assign(leaves, Entry{kDone, 0});
+
+        // winners bottom-up; each node keeps its loser
+        std::vector<Entry> winner(2 * leaves);
+        for (uint32_t i = 0; i < leaves; ++i) {
+            winner[leaves + i] = Entry{kDone, i};
+            if (i < streams.size()) {
+                Stream& st = streams[i];
+                if (st.cur == st.end) refill(st);
+                winner[leaves + i].key = head(st);
+            }
+        }
+        for (size_t node = leaves - 1; node > 0; --node) {
+            Entry a = winner[2 * node], b = winner[2 * node + 1];
+            bool b_wins = beats(b, a);
+            winner[node] = b_wins ? b : a;
+            tree[node] = b_wins ? a : b;
+        }
+        tree[0] = winner[1];
+        handed_out = false;
+    }
+
+    // next event in timestamp order and the stream it came from; nullptr
+    // once every stream is exhausted. The event stays valid until the next call
+    const OrderEvent* next(uint32_t& stream) {
+        if (OB_LIKELY(handed_out)) pop();
+        handed_out = tree[0].key != kDone;
+        if (OB_UNLIKELY(!handed_out)) return nullptr;
+        stream = tree[0].stream;
+        return streams[stream].cur;
+    }
+
+    // feed every remaining event to f(stream, event) in order; returns the count
+    template<typename F>
+    uint64_t drain(F&& f) {
+        if (handed_out) pop();
+        handed_out = false;
+        uint64_t n = 0;
+        for (; tree[0].key != kDone; ++n) {
+            f(tree[0].stream, *streams[tree[0].stream].cur);
+            pop();
+        }
+        return n;
+    }
+
+private:
+    // with hundreds of streams the hardware prefetcher loses track of them;
+    // fetch each stream's upcoming events a few lines early instead
+    static constexpr size_t kPrefetchEvents = 4;
+
+    struct Stream {
+        const OrderEvent* cur;
+        const OrderEvent* end;
+        ColumnarCursor* cursor;     // nullptr for spans
+    };
+
+    // a stream and its head timestamp; nodes carry the key so a replay
+    // compares without chasing the stream
+    struct Entry {
+        uint64_t key;
+        uint32_t stream;
+    };
+
+    static inline uint64_t head(const Stream& st) {
+        return st.cur != st.end ? st.cur->timestamp_ns : kDone;
+    }
+
+    // does a's head go before b's
+    static inline bool beats(const Entry& a, const Entry& b) {
+        return (a.key < b.key) | ((a.key == b.key) & (a.stream < b.stream));
+    }
+
+    // step the winner past its head event and replay its path to the root
+    inline void pop() {
+        Entry w = tree[0];
+        Stream& st = streams[w.stream];
+        if (OB_UNLIKELY(++st.cur == st.end)) refill(st);
+        w.key = head(st);
+        // only form the address inside the block: cur is null for a finished
+        // or empty stream, and the tail of a block has nothing left to fetch
+        if (st.end - st.cur > std::ptrdiff_t(kPrefetchEvents)) {
+            __builtin_prefetch(st.cur + kPrefetchEvents);
+        }
+
+        for (size_t node = (leaves + w.stream) >> 1; node > 0; node >>= 1) {
+            Entry l = tree[node];
+            bool l_wins = beats(l, w);
+            tree[node] = l_wins ? w : l;
+            w = l_wins ? l : w;
+        }
+        tree[0] = w;
+    }
+
+    // next decoded block of a columnar stream
+    OB_COLD void refill(Stream& st) {
+        if (!st.cursor) return;
+        size_t n;
+        st.cur = st.cursor->next(n);
+        st.end = st.cur + n;
+    }
+
+    std::vector<Stream> streams;
+    std::vector<Entry> tree;        // [0] winner, [1, leaves) losers; kDone past the end
+    size_t leaves = 1;
+    bool handed_out = false;
+
+    std::vector<std::unique_ptr<ColumnarCursor>> cursors;
+    std::vector<std::unique_ptr<ColumnarReader>> readers;
+    std::vector<std::unique_ptr<MappedFile>> files;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "orderbook/order.h"
+
+// Implied (synthetic) top of book for calendar spreads built from their
+// outright legs. A spread near - far is bought by buying near and selling
+// far, so its implied-in prices are
+//
+//   implied bid = near bid - far ask,  qty min(near bid qty, far ask qty)
+//   implied ask = near ask - far bid,  qty min(near ask qty, far bid qty)
+//
+// Legs report their top of book through on_leg_top(); each leg keeps the
+// list of spread sides it feeds, so a change recomputes only those sides:
+// a near-leg bid move touches the spread bid, a far-leg bid move the spread
+// ask, and a leg nobody depends on costs one comparison. Spreads whose
+// implied top actually changed are queued for drain_changed().
+class ImpliedBook {
+private:
+    // what a leg side feeds
+    struct Dependent {
+        uint32_t spread;
+        bool spread_bid;    // feeds the spread's bid (else its ask)
+    };
+
+    struct Leg {
+        TopOfBook top;
+        std::vector<Dependent> on_bid;      // spread sides fed by this leg's bid
+        std::vector<Dependent> on_ask;      // ... and by its ask
+    };
+
+    struct Spread {
+        uint32_t near_leg;
+        uint32_t far_leg;
+        TopOfBook implied;
+        bool queued = false;
+    };
+
+    std::vector<Leg> legs;
+    std::vector<Spread> spreads;
+    std::vector<uint32_t> changed;
+    uint64_t recomputed = 0;
+
+    static PriceLevel combine(const PriceLevel& buy_leg, const PriceLevel& sell_leg) {
+        if (buy_leg.total_quantity == 0 || sell_leg.total_quantity == 0) {
+            return PriceLevel();
+        }
+        return PriceLevel(buy_leg.price - sell_leg.price,
+                          std::min(buy_leg.total_quantity, sell_leg.total_quantity));
+    }
+
+    void recompute(const Dependent& dep) {
+        Spread& s = spreads[dep.spread];
+        const TopOfBook& near_top = legs[s.near_leg].top;
+        const TopOfBook& far_top = legs[s.far_leg].top;
+
+        PriceLevel& side = dep.spread_bid ? s.implied.bid : s.implied.ask;
+        PriceLevel next = dep.spread_bid ? combine(near_top.bid, far_top.ask)
+                                         : combine(near_top.ask, far_top.bid);
+        ++recomputed;
+
+        if (next.price != side.price || next.total_quantity != side.total_quantity) {
+            side = next;
+            if (!s.queued) {
+                s.queued = true;
+                changed.push_back(dep.spread);
+            }
+        }
+    }
+
+    static bool same_level(const PriceLevel& a, const PriceLevel& b) {
+        return a.price == b.price && a.total_quantity == b.total_quantity;
+    }
+
+public:
+    uint32_t add_leg() {
+        legs.emplace_back();
+        return static_cast<uint32_t>(legs.size() - 1);
+    }
+
+    // spread = near_leg - far_leg; returns the spread id
+    uint32_t add_calendar_spread(uint32_t near_leg, uint32_t far_leg) {
+        uint32_t id = static_cast<uint32_t>(spreads.size());
+        spreads.push_back(Spread{near_leg, far_leg, TopOfBook(), false});
+
+        legs[near_leg].on_bid.push_back(Dependent{id, true});
+        legs[near_leg].on_ask.push_back(Dependent{id, false});
+        legs[far_leg].on_ask.push_back(Dependent{id, true});
+        legs[far_leg].on_bid.push_back(Dependent{id, false});
+
+        recompute(Dependent{id, true});
+        recompute(Dependent{id, false});
+        return id;
+    }
+
+    // new top of book for a leg; returns the number of spread sides recomputed
+    size_t on_leg_top(uint32_t leg, const TopOfBook& top) {
+        Leg& l = legs[leg];
+        bool bid_moved = !same_level(l.top.bid, top.bid);
+        bool ask_moved = !same_level(l.top.ask, top.ask);
+        l.top = top;
+
+        size_t n = 0;
+        if (bid_moved) {
+            for (const Dependent& dep : l.on_bid) recompute(dep);
+            n += l.on_bid.size();
+        }
+        if (ask_moved) {
+            for (const Dependent& dep : l.on_ask) recompute(dep);
+            n += l.on_ask.size();
+        }
+        return n;
+    }
+
+    // convenience: read the leg's top straight from its book
+    template<typename Book>
+    size_t on_leg_book(uint32_t leg, const Book& book) {
+        return on_leg_top(leg, book.get_top());
+    }
+
+    const TopOfBook& implied(uint32_t spread) const {
+        return spreads[spread].implied;
+    }
+
+    // spreads whose implied top changed since the last drain, in order of
+    // first change
+    void drain_changed(std::vector<uint32_t>& out) {
+        out.clear();
+        out.swap(changed);
+        for (uint32_t id : out) spreads[id].queued = false;
+    }
+
+    size_t leg_count() const { return legs.size(); }
+    size_t spread_count() const { return spreads.size(); }
+
+    // total spread-side recomputations, for checking the dependency fan-out
+    uint64_t recomputations() const { return recomputed; }
+};
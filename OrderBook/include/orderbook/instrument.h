@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "orderbook/book_config.h"
+#include "orderbook/meta.h"
+
+// Instrument class descriptor: tick size TickNum/TickDen, the price band
+// (in ticks either side of the reference price) a book must hold, and the
+// largest ladder worth allocating. Everything the book derives from it is a
+// compile-time constant:
+//
+//   kTicksPerUnit   price -> ticks multiplier (no runtime division)
+//   kLadderLevels   slots per side: 2 * band + 1 rounded up to a power of two
+//                   (LadderSide derives its bitmap words from it)
+//   kUseLadder      ladder if it fits MaxLevels, else the tree side
+//
+//   using ES = Instrument<1, 4, 400>;     // 0.25 tick, +-100.00 band
+template<int64_t TickNum, int64_t TickDen, int64_t BandTicks, size_t MaxLevels = 65536>
+struct Instrument {
+    static_assert(TickNum > 0 && TickDen > 0, "tick size must be positive");
+    static_assert(BandTicks > 0, "band must be at least one tick");
+
+    // tick size as a reduced fraction
+    static constexpr int64_t kTickNum = TickNum / GCD<TickNum, TickDen>::value;
+    static constexpr int64_t kTickDen = TickDen / GCD<TickNum, TickDen>::value;
+    static constexpr double kTicksPerUnit = double(kTickDen) / double(kTickNum);
+
+    static constexpr int64_t kBandTicks = BandTicks;
+
+    static constexpr size_t kLadderLevels =
+        CeilPow2<(2 * BandTicks + 1 < 64 ? 64 : 2 * BandTicks + 1)>::value;
+    static constexpr bool kUseLadder = kLadderLevels <= MaxLevels;
+
+    static_assert(kLadderLevels >= size_t(2 * BandTicks + 1), "ladder must cover the band");
+};
+
+// price key = ticks of the instrument's tick size
+template<typename Inst>
+struct InstrumentPrice {
+    using Key = int64_t;
+
+    static constexpr bool kIntegral = true;
+
+    static inline Key to_key(double price) { return std::llround(price * Inst::kTicksPerUnit); }
+
+    static inline double to_price(Key key) {
+        return double(key * Inst::kTickNum) / double(Inst::kTickDen);
+    }
+};
+
+// book configuration for an instrument class: a ladder sized from the band
+// when it fits, otherwise the tree; a direct id table when MaxIds is given
+template<typename Inst, uint64_t MaxIds = 0>
+struct InstrumentConfig : DefaultConfig {
+    using Price = InstrumentPrice<Inst>;
+
+    template<typename Key, typename Level, bool Bid>
+    using Side = std::conditional_t<Inst::kUseLadder,
+                                    LadderSide<Key, Level, Bid, Inst::kLadderLevels>,
+                                    MapSide<Key, Level, Bid>>;
+
+    using Index = std::conditional_t<MaxIds != 0, DirectOrderIndex<MaxIds>, OrderIndex>;
+
+    static constexpr bool kBranchlessLevels = Inst::kUseLadder;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "orderbook/compiler.h"
+
+// fixed-size slab allocator handing out 32-bit handles instead of pointers:
+// handle = slab number << kSlabShift | index within slab. Links stored as
+// handles are half the size of pointers and stay valid if the slabs move,
+// so the whole pool can be saved and restored with flat copies.
+template<typename T, size_t BlockSize = 4096>
+class MemoryPool {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle kNullHandle = UINT32_MAX;
+
+private:
+    static constexpr size_t floor_log2(size_t n) {
+        return n <= 1 ? 0 : 1 + floor_log2(n / 2);
+    }
+
+public:
+    // slab size is rounded down to a power of two so decoding is shift + mask
+    static constexpr size_t kSlabShift = floor_log2(BlockSize / sizeof(T));
+    static constexpr size_t kSlotsPerBlock = size_t(1) << kSlabShift;
+    static constexpr size_t kSlabMask = kSlotsPerBlock - 1;
+
+    static_assert(BlockSize >= sizeof(T), "BlockSize must hold at least one object");
+    static_assert(sizeof(T) >= sizeof(Handle), "free slots store the next free handle");
+
+private:
+    struct Block {
+        alignas(T) uint8_t data[kSlotsPerBlock * sizeof(T)];
+    };
+
+    std::vector<Block*> all_blocks;
+    Handle free_head;   // intrusive free list threaded through freed slots
+    Handle next_slot;   // first never-used slot
+    size_t allocated;
+
+    inline Handle& free_link(Handle h) {
+        return *reinterpret_cast<Handle*>(&at(h));
+    }
+
+public:
+    MemoryPool() : free_head(kNullHandle), next_slot(0), allocated(0) {
+        allocate_block();
+    }
+
+    ~MemoryPool() {
+        for (auto* block : all_blocks) {
+            delete block;
+        }
+    }
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    void allocate_block() {
+        all_blocks.push_back(new Block());
+    }
+
+    // pre-allocate slabs for at least n objects
+    void reserve(size_t n) {
+        while (capacity() < n) allocate_block();
+    }
+
+    template<typename... Args>
+    Handle allocate(Args&&... args) {
+        Handle h;
+        if (free_head != kNullHandle) {
+            h = free_head;
+            free_head = free_link(h);
+        } else {
+            if (OB_UNLIKELY(next_slot == all_blocks.size() * kSlotsPerBlock)) {
+                allocate_block();
+            }
+            h = next_slot++;
+        }
+        ++allocated;
+
+        new (&at(h)) T(std::forward<Args>(args)...);
+        return h;
+    }
+
+    void deallocate(Handle h) {
+        at(h).~T();
+        free_link(h) = free_head;
+        free_head = h;
+        --allocated;
+    }
+
+    inline T& at(Handle h) {
+        return reinterpret_cast<T*>(all_blocks[h >> kSlabShift]->data)[h & kSlabMask];
+    }
+
+    inline const T& at(Handle h) const {
+        return reinterpret_cast<const T*>(all_blocks[h >> kSlabShift]->data)[h & kSlabMask];
+    }
+
+    // pull a slot toward L1 ahead of a write to it
+    inline void prefetch(Handle h) const {
+        __builtin_prefetch(&at(h), 1);
+    }
+
+    void reset() {
+        free_head = kNullHandle;
+        next_slot = 0;
+        allocated = 0;
+    }
+
+    // flat image of the pool: header followed by each used slab verbatim
+    void save(std::vector<uint8_t>& out) const {
+        static_assert(std::is_trivially_copyable<T>::value, "pool image needs trivially copyable T");
+        size_t slabs = (next_slot + kSlotsPerBlock - 1) >> kSlabShift;
+        uint64_t header[3] = {free_head, next_slot, allocated};
+
+        out.resize(sizeof(header) + slabs * sizeof(Block));
+        std::memcpy(out.data(), header, sizeof(header));
+        uint8_t* dst = out.data() + sizeof(header);
+        for (size_t i = 0; i < slabs; ++i, dst += sizeof(Block)) {
+            std::memcpy(dst, all_blocks[i]->data, sizeof(Block));
+        }
+    }
+
+    // restore an image written by save(); handles taken before save() are
+    // valid again afterwards
+    bool load(const uint8_t* data, size_t size) {
+        uint64_t header[3];
+        if (size < sizeof(header)) return false;
+        std::memcpy(header, data, sizeof(header));
+        size_t slabs = (size - sizeof(header)) / sizeof(Block);
+        if (sizeof(header) + slabs * sizeof(Block) != size ||
+            header[1] > slabs * kSlotsPerBlock) {
+            return false;
+        }
+
+        while (all_blocks.size() < slabs) allocate_block();
+        data += sizeof(header);
+        for (size_t i = 0; i < slabs; ++i, data += sizeof(Block)) {
+            std::memcpy(all_blocks[i]->data, data, sizeof(Block));
+        }
+        free_head = static_cast<Handle>(header[0]);
+        next_slot = static_cast<Handle>(header[1]);
+        allocated = static_cast<size_t>(header[2]);
+        return true;
+    }
+
+    size_t size() const { return allocated; }
+    size_t capacity() const { return all_blocks.size() * kSlotsPerBlock; }
+
+    // the next allocate() would have to add a slab
+    bool full() const { return free_head == kNullHandle && next_slot == capacity(); }
+};
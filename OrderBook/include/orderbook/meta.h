@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Compile-time integer helpers, written as recursive templates like the L9
+// metaprogramming examples (Factorial, GCD, Fibonacci).
+
+// floor(log2(N)), N >= 1
+template<uint64_t N>
+struct Log2 {
+    static constexpr unsigned value = 1 + Log2<N / 2>::value;
+};
+
+template<>
+struct Log2<1> {
+    static constexpr unsigned value = 0;
+};
+
+// smallest power of two >= N
+template<uint64_t N>
+struct CeilPow2 {
+    static constexpr uint64_t value = uint64_t(1) << (Log2<N - 1>::value + 1);
+};
+
+template<>
+struct CeilPow2<1> {
+    static constexpr uint64_t value = 1;
+};
+
+template<int64_t A, int64_t B>
+struct GCD {
+    static constexpr int64_t value = GCD<B, A % B>::value;
+};
+
+template<int64_t A>
+struct GCD<A, 0> {
+    static constexpr int64_t value = A;
+};
+
+static_assert(Log2<64>::value == 6 && Log2<65>::value == 6, "Log2");
+static_assert(CeilPow2<64>::value == 64 && CeilPow2<65>::value == 128, "CeilPow2");
+static_assert(GCD<48, 18>::value == 6, "GCD");
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Lock-free runtime metrics for the order book.
+//
+// Every book owns one cache-line aligned BookCounters block and is its only
+// writer, so increments are a relaxed load + store (no lock prefix, no RMW)
+// and the line never bounces between writer threads. A reader thread sums
+// the blocks with relaxed loads and exports them as text.
+
+// one counter per cache line would waste space: all fields of a block are
+// written by the same thread, the alignment only keeps separate books apart
+struct alignas(64) BookCounters {
+    using Cell = std::atomic<uint64_t>;
+
+    // monotonic counters
+    Cell messages{0};
+    Cell orders_added{0};
+    Cell orders_canceled{0};
+    Cell orders_amended{0};
+    Cell orders_expired{0};
+    Cell orders_executed{0};
+    Cell rejects{0};
+
+    // gauges, overwritten by the book after each mutation
+    Cell resting_orders{0};
+    Cell bid_levels{0};
+    Cell ask_levels{0};
+    Cell pool_used{0};
+    Cell pool_capacity{0};
+    Cell index_buckets{0};
+
+    // single writer: avoid the locked RMW that fetch_add would emit
+    static inline void bump(Cell& c, uint64_t n = 1) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static inline void set(Cell& c, uint64_t v) {
+        c.store(v, std::memory_order_relaxed);
+    }
+};
+
+static_assert(sizeof(BookCounters) % 64 == 0, "counter blocks must not share cache lines");
+
+// plain copy of a counter block (or a sum of several) taken by the reader
+struct MetricsSnapshot {
+    uint64_t messages = 0;
+    uint64_t orders_added = 0;
+    uint64_t orders_canceled = 0;
+    uint64_t orders_amended = 0;
+    uint64_t orders_expired = 0;
+    uint64_t orders_executed = 0;
+    uint64_t rejects = 0;
+    uint64_t resting_orders = 0;
+    uint64_t bid_levels = 0;
+    uint64_t ask_levels = 0;
+    uint64_t pool_used = 0;
+    uint64_t pool_capacity = 0;
+    uint64_t index_buckets = 0;
+
+    void accumulate(const BookCounters& c) {
+        constexpr auto r = std::memory_order_relaxed;
+        messages += c.messages.load(r);
+        orders_added += c.orders_added.load(r);
+        orders_canceled += c.orders_canceled.load(r);
+        orders_amended += c.orders_amended.load(r);
+        orders_expired += c.orders_expired.load(r);
+        orders_executed += c.orders_executed.load(r);
+        rejects += c.rejects.load(r);
+        resting_orders += c.resting_orders.load(r);
+        bid_levels += c.bid_levels.load(r);
+        ask_levels += c.ask_levels.load(r);
+        pool_used += c.pool_used.load(r);
+        pool_capacity += c.pool_capacity.load(r);
+        index_buckets += c.index_buckets.load(r);
+    }
+
+    double load_factor() const {
+        return index_buckets ? double(resting_orders) / double(index_buckets) : 0.0;
+    }
+};
+
+// Fixed table of counter blocks. Blocks are owned by the registry, not by the
+// books, so the reader never touches freed memory when a book goes away; a
+// released block is skipped by the exporter and reused by a later acquire,
+// which zeroes it and bumps its generation (so rates never see the reset).
+// The generation doubles as a seqlock over the name: odd while acquire
+// rewrites it, so the exporter never prints a label torn by a reuse.
+class MetricsRegistry {
+public:
+    static constexpr size_t kMaxBooks = 256;
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // claim a free block for a book; nullptr while all kMaxBooks are in use
+    BookCounters* acquire(const char* name) {
+        for (size_t slot = 0; slot < kMaxBooks; ++slot) {
+            Entry& e = entries_[slot];
+            bool free = false;
+            if (e.claimed.load(std::memory_order_relaxed) ||
+                !e.claimed.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+                continue;
+            }
+            reset(e.counters);
+
+            char label[kNameBytes] = {};
+            std::snprintf(label, sizeof(label), "%s", name);
+            e.generation.fetch_add(1, std::memory_order_relaxed);     // odd: name in flux
+            for (size_t w = 0; w < kNameWords; ++w) {
+                uint64_t word;
+                std::memcpy(&word, label + w * sizeof(word), sizeof(word));
+                e.name[w].store(word, std::memory_order_release);   // stays after the odd bump
+            }
+            e.generation.fetch_add(1, std::memory_order_release);
+            e.live.store(true, std::memory_order_release);
+
+            // high-water mark the reader scans up to
+            size_t used = used_.load(std::memory_order_relaxed);
+            while (used < slot + 1 &&
+                   !used_.compare_exchange_weak(used, slot + 1, std::memory_order_release)) {
+            }
+            return &e.counters;
+        }
+        return nullptr;
+    }
+
+    void release(BookCounters* counters) {
+        for (auto& e : entries_) {
+            if (&e.counters == counters) {
+                e.live.store(false, std::memory_order_release);
+                e.claimed.store(false, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    size_t size() const { return used_.load(std::memory_order_acquire); }
+
+    bool live(size_t i) const { return entries_[i].live.load(std::memory_order_acquire); }
+
+    // copy slot i's name; false if the slot is not live or was reused
+    // while copying (the caller skips it this round)
+    bool read_name(size_t i, std::string& out) const {
+        const Entry& e = entries_[i];
+        uint64_t before = e.generation.load(std::memory_order_acquire);
+        if ((before & 1) || !e.live.load(std::memory_order_acquire)) return false;
+        char label[kNameBytes];
+        for (size_t w = 0; w < kNameWords; ++w) {
+            uint64_t word = e.name[w].load(std::memory_order_acquire);  // stays before the recheck
+            std::memcpy(label + w * sizeof(word), &word, sizeof(word));
+        }
+        if (e.generation.load(std::memory_order_relaxed) != before) return false;
+        label[kNameBytes - 1] = '\0';
+        out = label;
+        return true;
+    }
+
+    const BookCounters& counters(size_t i) const { return entries_[i].counters; }
+
+    // changes each time slot i is handed to a new book (odd while it is)
+    uint64_t generation(size_t i) const { return entries_[i].generation.load(std::memory_order_acquire); }
+
+    MetricsSnapshot snapshot(size_t i) const {
+        MetricsSnapshot s;
+        s.accumulate(entries_[i].counters);
+        return s;
+    }
+
+    MetricsSnapshot total() const {
+        MetricsSnapshot s;
+        for (size_t i = 0, n = size(); i < n; ++i) {
+            if (live(i)) s.accumulate(entries_[i].counters);
+        }
+        return s;
+    }
+
+private:
+    // names up to 47 characters, stored as words so the exporter's copy is
+    // race-free
+    static constexpr size_t kNameWords = 6;
+    static constexpr size_t kNameBytes = kNameWords * sizeof(uint64_t);
+
+    struct Entry {
+        BookCounters counters;
+        std::atomic<bool> live{false};      // exported
+        std::atomic<bool> claimed{false};   // owned by a book
+        std::atomic<uint64_t> generation{0};
+        std::array<std::atomic<uint64_t>, kNameWords> name{};
+    };
+
+    static void reset(BookCounters& c) {
+        for (BookCounters::Cell* cell : {&c.messages, &c.orders_added, &c.orders_canceled, &c.orders_amended,
+                                         &c.orders_expired, &c.orders_executed, &c.rejects, &c.resting_orders,
+                                         &c.bid_levels, &c.ask_levels, &c.pool_used, &c.pool_capacity,
+                                         &c.index_buckets}) {
+            BookCounters::set(*cell, 0);
+        }
+    }
+
+    std::atomic<size_t> used_{0};
+    std::array<Entry, kMaxBooks> entries_;
+};
+
+// Background reader: aggregates the registry every interval and rewrites a
+// Prometheus-style text file. Pointing it at /dev/shm gives a shared-memory
+// page that any local process (or `cat`) can read; the file is replaced by
+// rename so readers never see a torn update.
+class MetricsExporter {
+public:
+    MetricsExporter(const MetricsRegistry& registry, std::string path,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(1000))
+        : registry_(registry), path_(std::move(path)), interval_(interval) {}
+
+    ~MetricsExporter() { stop(); }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void start() {
+        if (thread_.joinable()) return;
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    // wakes the loop mid-interval, so this returns after at most one export
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    // render and write once; also used by the background loop
+    bool export_now() {
+        auto now = std::chrono::steady_clock::now();
+        MetricsSnapshot total = registry_.total();
+
+        // rate from per-block deltas: the total drops when a book is released,
+        // and a reused block restarts from 0 under a new generation
+        uint64_t new_messages = 0;
+        for (size_t i = 0, n = registry_.size(); i < n; ++i) {
+            if (!registry_.live(i)) continue;
+            uint64_t gen = registry_.generation(i);
+            uint64_t messages = registry_.counters(i).messages.load(std::memory_order_relaxed);
+            bool same = gen == last_generation_[i] && messages >= last_messages_[i];
+            new_messages += same ? messages - last_messages_[i] : messages;
+            last_generation_[i] = gen;
+            last_messages_[i] = messages;
+        }
+        double msg_rate = 0.0;
+        if (has_last_) {
+            double secs = std::chrono::duration<double>(now - last_time_).count();
+            if (secs > 0.0) msg_rate = double(new_messages) / secs;
+        }
+        has_last_ = true;
+        last_time_ = now;
+
+        std::string tmp = path_ + ".tmp";
+        FILE* f = std::fopen(tmp.c_str(), "w");
+        if (!f) return false;
+
+        std::fprintf(f, "orderbook_messages_per_second %.1f\n", msg_rate);
+        std::string name;
+        for (size_t i = 0, n = registry_.size(); i < n; ++i) {
+            if (registry_.read_name(i, name)) write_block(f, name.c_str(), registry_.snapshot(i));
+        }
+        write_block(f, "all", total);
+
+        std::fclose(f);
+        return std::rename(tmp.c_str(), path_.c_str()) == 0;
+    }
+
+private:
+    static void write_block(FILE* f, const char* book, const MetricsSnapshot& s) {
+        auto line = [&](const char* metric, uint64_t v) {
+            std::fprintf(f, "orderbook_%s{book=\"%s\"} %llu\n", metric, book,
+                         static_cast<unsigned long long>(v));
+        };
+        line("messages_total", s.messages);
+        line("orders_added_total", s.orders_added);
+        line("orders_canceled_total", s.orders_canceled);
+        line("orders_amended_total", s.orders_amended);
+        line("orders_expired_total", s.orders_expired);
+        line("orders_executed_total", s.orders_executed);
+        line("rejects_total", s.rejects);
+        line("resting_orders", s.resting_orders);
+        line("bid_levels", s.bid_levels);
+        line("ask_levels", s.ask_levels);
+        line("pool_used", s.pool_used);
+        line("pool_capacity", s.pool_capacity);
+        std::fprintf(f, "orderbook_index_load_factor{book=\"%s\"} %.4f\n", book, s.load_factor());
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (running_) {
+            lock.unlock();
+            export_now();
+            lock.lock();
+            wake_.wait_for(lock, interval_, [this] { return !running_; });
+        }
+    }
+
+    const MetricsRegistry& registry_;
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    std::thread thread_;
+
+    // exporter thread sleeps here between exports; stop() wakes it
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+
+    bool has_last_ = false;
+    std::chrono::steady_clock::time_point last_time_;
+    std::array<uint64_t, MetricsRegistry::kMaxBooks> last_generation_{};
+    std::array<uint64_t, MetricsRegistry::kMaxBooks> last_messages_{};
+};
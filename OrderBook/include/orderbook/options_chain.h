@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "orderbook/compiler.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order.h"
+#include "orderbook/order_index.h"
+#include "orderbook/small_vector.h"
+
+// Every series of one underlying in a single container: one order pool and
+// one id index shared by all series, and per-series price levels held in
+// small vectors that stay inline until a series gets busy. A nearly empty
+// series costs sizeof(Series) (128 bytes, two inline levels a side) instead
+// of a whole OrderBook with its own pool slab, hash table and trees.
+//
+// Order ids are unique across the chain. Levels are kept sorted best first
+// and searched with a binary search; thin books rarely hold more than a few.
+class OptionsChain {
+private:
+    struct ChainNode {
+        Order order;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t series;
+
+        ChainNode(const Order& o, uint32_t s) : order(o), prev(UINT32_MAX), next(UINT32_MAX), series(s) {}
+    };
+
+    using NodePool = MemoryPool<ChainNode, 8192>;
+    using Handle = NodePool::Handle;
+    static constexpr Handle kNullHandle = NodePool::kNullHandle;
+
+    struct Level {
+        double price;
+        Handle head;
+        Handle tail;
+        uint64_t total_quantity;
+    };
+
+    using Levels = SmallVector<Level, 2>;
+
+    struct Series {
+        Levels bids;    // highest first
+        Levels asks;    // lowest first
+    };
+    static_assert(sizeof(Series) == 128, "an idle series should stay two inline levels a side");
+
+    NodePool pool;
+    OrderIndex index;
+    std::vector<Series> chain;
+
+    inline auto key_of() const {
+        return [this](Handle h) { return pool.at(h).order.order_id; };
+    }
+
+    // first level not better than price: where price sits or would be inserted
+    static Level* seek(Levels& levels, bool is_buy, double price) {
+        return std::lower_bound(levels.begin(), levels.end(), price,
+                                [is_buy](const Level& l, double p) {
+                                    return is_buy ? l.price > p : l.price < p;
+                                });
+    }
+
+    bool insert(uint32_t series, const Order& order) {
+        Handle h = pool.allocate(order, series);
+        if (OB_UNLIKELY(!index.insert(order.order_id, h, key_of()))) {
+            pool.deallocate(h);
+            return false;
+        }
+
+        Series& s = chain[series];
+        Levels& levels = order.is_buy ? s.bids : s.asks;
+        Level* level = seek(levels, order.is_buy, order.price);
+        if (level == levels.end() || level->price != order.price) {
+            level = levels.insert(level, Level{order.price, kNullHandle, kNullHandle, 0});
+        }
+
+        ChainNode& node = pool.at(h);
+        node.prev = level->tail;
+        if (level->tail != kNullHandle) {
+            pool.at(level->tail).next = h;
+        } else {
+            level->head = h;
+        }
+        level->tail = h;
+        level->total_quantity += order.quantity;
+        return true;
+    }
+
+    void erase(Handle h) {
+        ChainNode& node = pool.at(h);
+        Series& s = chain[node.series];
+        Levels& levels = node.order.is_buy ? s.bids : s.asks;
+        Level* level = seek(levels, node.order.is_buy, node.order.price);
+
+        level->total_quantity -= node.order.quantity;
+        if (node.prev != kNullHandle) {
+            pool.at(node.prev).next = node.next;
+        } else {
+            level->head = node.next;
+        }
+        if (node.next != kNullHandle) {
+            pool.at(node.next).prev = node.prev;
+        } else {
+            level->tail = node.prev;
+        }
+        if (level->head == kNullHandle) {
+            levels.erase(level);
+        }
+
+        index.erase(node.order.order_id, key_of());
+        pool.deallocate(h);
+    }
+
+public:
+    OptionsChain() = default;
+
+    explicit OptionsChain(size_t series_count) : chain(series_count) {}
+
+    OptionsChain(const OptionsChain&) = delete;
+    OptionsChain& operator=(const OptionsChain&) = delete;
+
+    // append a series; returns its id
+    uint32_t add_series() {
+        chain.emplace_back();
+        return static_cast<uint32_t>(chain.size() - 1);
+    }
+
+    size_t series_count() const {
+        return chain.size();
+    }
+
+    // size the shared pool and index for the whole chain's resting orders
+    void reserve(size_t expected_orders) {
+        pool.reserve(expected_orders);
+        index.reserve(expected_orders);
+    }
+
+    // rejects an unknown series or an order_id already resting anywhere in the chain
+    bool add_order(uint32_t series, const Order& order) {
+        if (OB_UNLIKELY(series >= chain.size())) {
+            return false;
+        }
+        return insert(series, order);
+    }
+
+    bool cancel_order(uint64_t order_id) {
+        Handle h = index.find(order_id, key_of());
+        if (OB_UNLIKELY(h == OrderIndex::kInvalid)) {
+            return false;
+        }
+        erase(h);
+        return true;
+    }
+
+    // same semantics as OrderBook::amend_order; the order stays in its series
+    bool amend_order(uint64_t order_id, double new_price, uint64_t new_quantity) {
+        Handle h = index.find(order_id, key_of());
+        if (OB_UNLIKELY(h == OrderIndex::kInvalid)) {
+            return false;
+        }
+
+        ChainNode& node = pool.at(h);
+        if (node.order.price != new_price) {
+            if (OB_UNLIKELY(new_quantity == 0)) {
+                return false;   // as the book: a reprice to 0 is rejected, order kept
+            }
+            Order moved = node.order;
+            uint32_t series = node.series;
+            moved.price = new_price;
+            moved.quantity = new_quantity;
+            erase(h);
+            return insert(series, moved);
+        }
+
+        Levels& levels = node.order.is_buy ? chain[node.series].bids : chain[node.series].asks;
+        Level* level = seek(levels, node.order.is_buy, node.order.price);
+        level->total_quantity = level->total_quantity - node.order.quantity + new_quantity;
+        node.order.quantity = new_quantity;
+        if (OB_UNLIKELY(new_quantity == 0)) {
+            erase(h);
+        }
+        return true;
+    }
+
+    // series an order rests in, or UINT32_MAX
+    uint32_t series_of(uint64_t order_id) const {
+        Handle h = index.find(order_id, key_of());
+        return h == OrderIndex::kInvalid ? UINT32_MAX : pool.at(h).series;
+    }
+
+    void get_snapshot(uint32_t series, size_t depth,
+                      std::vector<PriceLevel>& bids_out, std::vector<PriceLevel>& asks_out) const {
+        bids_out.clear();
+        asks_out.clear();
+        if (series >= chain.size()) return;
+
+        const Series& s = chain[series];
+        for (size_t i = 0; i < s.bids.size() && i < depth; ++i) {
+            bids_out.emplace_back(s.bids[i].price, s.bids[i].total_quantity);
+        }
+        for (size_t i = 0; i < s.asks.size() && i < depth; ++i) {
+            asks_out.emplace_back(s.asks[i].price, s.asks[i].total_quantity);
+        }
+    }
+
+    size_t get_total_orders() const {
+        return index.size();
+    }
+
+    size_t get_levels(uint32_t series, bool is_buy) const {
+        return is_buy ? chain[series].bids.size() : chain[series].asks.size();
+    }
+
+    // bytes held by the chain: series table, spilled level storage, shared
+    // pool slabs and index
+    size_t memory_bytes() const {
+        size_t bytes = chain.capacity() * sizeof(Series);
+        for (const Series& s : chain) {
+            bytes += s.bids.heap_bytes() + s.asks.heap_bytes();
+        }
+        return bytes + pool.capacity() * sizeof(ChainNode) + index.memory_bytes();
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+struct Order {
+    uint64_t order_id;
+    bool is_buy;
+    uint32_t owner;         // participant / session id, used for mass cancel; UINT32_MAX reserved
+    double price;
+    uint64_t quantity;
+    uint64_t timestamp_ns;
+    uint64_t expiry_ns;     // 0 = good till cancel
+
+    Order(uint64_t id, bool buy, double p, uint64_t q, uint64_t ts,
+          uint32_t own = 0, uint64_t expiry = 0)
+        : order_id(id), is_buy(buy), owner(own), price(p), quantity(q),
+          timestamp_ns(ts), expiry_ns(expiry) {}
+};
+
+// 64-bit fingerprint of an order's book-visible state (id, side, price,
+// quantity). Books XOR these into a running checksum, so two books holding
+// the same orders agree on it whatever their price or index policies
+inline uint64_t order_hash(const Order& o) {
+    auto mix = [](uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        return x ^ (x >> 33);
+    };
+    uint64_t price_bits;
+    std::memcpy(&price_bits, &o.price, sizeof(price_bits));
+    return mix(o.order_id ^ mix(price_bits ^ mix((o.quantity << 1) | uint64_t(o.is_buy))));
+}
+
+struct PriceLevel {
+    double price;
+    uint64_t total_quantity;
+
+    PriceLevel(double p = 0.0, uint64_t q = 0) : price(p), total_quantity(q) {}
+};
+
+// new aggregate quantity of one price level after a book update;
+// quantity 0 = the level is gone
+struct LevelDelta {
+    double price;
+    uint64_t quantity;
+    bool is_buy;
+};
+
+// best level each side; total_quantity 0 = side empty
+struct TopOfBook {
+    PriceLevel bid;
+    PriceLevel ask;
+
+    bool operator==(const TopOfBook& o) const {
+        return bid.price == o.bid.price && bid.total_quantity == o.bid.total_quantity &&
+               ask.price == o.ask.price && ask.total_quantity == o.ask.total_quantity;
+    }
+    bool operator!=(const TopOfBook& o) const { return !(*this == o); }
+};
@@ -0,0 +1,867 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "orderbook/book_config.h"
+#include "orderbook/compiler.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/metrics.h"
+#include "orderbook/order.h"
+#include "orderbook/order_columns.h"
+#include "orderbook/order_event.h"
+#include "orderbook/timer_wheel.h"
+
+// Limit order book assembled at compile time from Config (book_config.h):
+// price keys, side containers, id index and pool sizing are all template
+// policies, so each instrument class gets its own specialized build with no
+// virtual dispatch. OrderBook is the DefaultConfig instantiation.
+template<typename Config>
+class BasicOrderBook {
+public:
+    using Price = typename Config::Price;
+    using PriceKey = typename Price::Key;
+    using Index = typename Config::Index;
+
+private:
+    // pooled order record with intrusive FIFO links; side and price of a
+    // resting order are read from here rather than duplicated in the index
+    struct OrderNode {
+        Order order;
+        uint32_t prev;
+        uint32_t next;
+
+        explicit OrderNode(const Order& o) : order(o), prev(UINT32_MAX), next(UINT32_MAX) {}
+    };
+
+    using OrderPool = MemoryPool<OrderNode, Config::kPoolBlockSize>;
+    using OrderHandle = typename OrderPool::Handle;
+    static constexpr OrderHandle kNullHandle = OrderPool::kNullHandle;
+
+    // price level data structure: price -> intrusive list of orders (FIFO)
+    struct PriceLevelData {
+        OrderHandle head = kNullHandle;
+        OrderHandle tail = kNullHandle;
+        uint64_t total_quantity = 0;
+
+        inline bool empty() const {
+            return head == kNullHandle;
+        }
+
+        inline void add_order(OrderPool& pool, OrderHandle h) {
+            OrderNode& node = pool.at(h);
+            node.prev = tail;
+            node.next = kNullHandle;
+            if constexpr (Config::kBranchlessLevels) {
+                // the link to write is the old tail's next, or head; the
+                // null case reads h's own slot so the address stays valid
+                bool has_tail = tail != kNullHandle;
+                OrderHandle* link = &pool.at(branchless_select(has_tail, tail, h)).next;
+                *branchless_select(has_tail, link, &head) = h;
+            } else if (OB_LIKELY(tail != kNullHandle)) {
+                pool.at(tail).next = h;
+            } else {
+                head = h;
+            }
+            tail = h;
+            total_quantity += node.order.quantity;
+        }
+
+        inline void remove_order(OrderPool& pool, OrderHandle h) {
+            OrderNode& node = pool.at(h);
+            total_quantity -= node.order.quantity;
+            if constexpr (Config::kBranchlessLevels) {
+                OrderHandle prev = node.prev, next = node.next;
+                bool has_prev = prev != kNullHandle, has_next = next != kNullHandle;
+                OrderHandle* prev_link = &pool.at(branchless_select(has_prev, prev, h)).next;
+                OrderHandle* next_link = &pool.at(branchless_select(has_next, next, h)).prev;
+                *branchless_select(has_prev, prev_link, &head) = next;
+                *branchless_select(has_next, next_link, &tail) = prev;
+            } else {
+                if (node.prev != kNullHandle) {
+                    pool.at(node.prev).next = node.next;
+                } else {
+                    head = node.next;
+                }
+                if (node.next != kNullHandle) {
+                    pool.at(node.next).prev = node.prev;
+                } else {
+                    tail = node.prev;
+                }
+            }
+        }
+
+        inline void update_quantity(const OrderNode& node, uint64_t old_qty) {
+            total_quantity = total_quantity - old_qty + node.order.quantity;
+        }
+    };
+
+    using BidSide = typename Config::template Side<PriceKey, PriceLevelData, true>;
+    using AskSide = typename Config::template Side<PriceKey, PriceLevelData, false>;
+
+    // bids: best (highest) first
+    BidSide bids;
+
+    // asks: best (lowest) first
+    AskSide asks;
+
+    // memory pool for orders
+    OrderPool order_pool;
+
+    // O(1) order lookup: order_id -> pool handle
+    Index order_index;
+
+    // run f on the side an order rests on; both sides share one interface
+    template<typename F>
+    inline decltype(auto) with_side(bool is_buy, F&& f) {
+        return is_buy ? f(bids) : f(asks);
+    }
+
+    inline auto key_of() const {
+        return [this](OrderHandle h) { return order_pool.at(h).order.order_id; };
+    }
+
+    // expiry timers for orders with expiry_ns set, keyed by pool handle
+    TimerWheel expiry_wheel;
+
+    // optional SoA mirror of the pool for bulk scans
+    bool use_columns = false;
+    OrderColumns columns;
+
+    // optional per-level change feed (consolidation, market data)
+    std::vector<LevelDelta>* delta_sink = nullptr;
+
+    inline void publish_level(bool is_buy, PriceKey key, uint64_t quantity) {
+        if (delta_sink) {
+            if (OB_UNLIKELY(batching)) {
+                touch_level(is_buy, key, quantity);
+            } else {
+                delta_sink->push_back(LevelDelta{Price::to_price(key), quantity, is_buy});
+            }
+        }
+    }
+
+    // inside a batched apply: each level changed so far with its latest
+    // quantity, in first-touch order, and an open-addressing table over them
+    struct Touched {
+        PriceKey key;
+        uint64_t quantity;
+        uint32_t slot;      // its entry in touched_index
+        bool is_buy;
+    };
+    static constexpr uint32_t kNoLevel = UINT32_MAX;
+    bool batching = false;
+    std::vector<Touched> touched;
+    std::vector<uint32_t> touched_index;
+
+    static inline size_t level_hash(bool is_buy, PriceKey key) {
+        static_assert(sizeof(PriceKey) <= sizeof(uint64_t), "price keys hash as one word");
+        uint64_t bits = 0;
+        std::memcpy(&bits, &key, sizeof(key));
+        return size_t(((bits ^ uint64_t(is_buy)) * 0x9e3779b97f4a7c15ULL) >> 32);
+    }
+
+    inline void touch_level(bool is_buy, PriceKey key, uint64_t quantity) {
+        if (OB_UNLIKELY((touched.size() + 1) * 2 > touched_index.size())) {
+            grow_touched();
+        }
+        size_t mask = touched_index.size() - 1;
+        for (size_t i = level_hash(is_buy, key) & mask;; i = (i + 1) & mask) {
+            uint32_t t = touched_index[i];
+            if (t == kNoLevel) {
+                touched_index[i] = uint32_t(touched.size());
+                touched.push_back(Touched{key, quantity, uint32_t(i), is_buy});
+                return;
+            }
+            if (touched[t].key == key && touched[t].is_buy == is_buy) {
+                touched[t].quantity = quantity;
+                return;
+            }
+        }
+    }
+
+    OB_COLD void grow_touched() {
+        touched_index.assign(std::max<size_t>(64, touched_index.size() * 2), kNoLevel);
+        size_t mask = touched_index.size() - 1;
+        for (uint32_t t = 0; t < touched.size(); ++t) {
+            size_t i = level_hash(touched[t].is_buy, touched[t].key) & mask;
+            while (touched_index[i] != kNoLevel) i = (i + 1) & mask;
+            touched_index[i] = t;
+            touched[t].slot = uint32_t(i);
+        }
+    }
+
+    // one delta per touched level, carrying its final quantity
+    void flush_touched() {
+        for (const Touched& t : touched) {
+            delta_sink->push_back(LevelDelta{Price::to_price(t.key), t.quantity, t.is_buy});
+            touched_index[t.slot] = kNoLevel;
+        }
+        touched.clear();
+    }
+
+    // XOR of order_hash over resting orders (Config::kChecksum only)
+    uint64_t checksum = 0;
+
+    inline void toggle_checksum(const Order& order) {
+        if constexpr (Config::kChecksum) {
+            checksum ^= order_hash(order);
+        }
+    }
+
+    // runtime metrics; points at own_counters until attached to a registry
+    BookCounters own_counters;
+    BookCounters* counters = &own_counters;
+    MetricsRegistry* metrics_registry = nullptr;
+
+    // refresh gauges after a mutation (relaxed stores to a line only we write)
+    inline void publish_gauges() {
+        BookCounters::set(counters->resting_orders, order_index.size());
+        BookCounters::set(counters->bid_levels, bids.size());
+        BookCounters::set(counters->ask_levels, asks.size());
+        BookCounters::set(counters->pool_used, order_pool.size());
+        BookCounters::set(counters->pool_capacity, order_pool.capacity());
+        BookCounters::set(counters->index_buckets, order_index.bucket_count());
+    }
+
+    // rare paths, kept out of line
+
+    OB_COLD bool reject() {
+        BookCounters::bump(counters->rejects);
+        return false;
+    }
+
+    // undo a half-done insert: duplicate or out-of-range id, or an order
+    // already past expiry
+    OB_COLD bool abandon_insert(OrderHandle h, bool indexed) {
+        if (indexed) {
+            order_index.erase(order_pool.at(h).order.order_id, key_of());
+        }
+        order_pool.deallocate(h);
+        return false;
+    }
+
+    // an indexed order whose price level is missing: the book is inconsistent,
+    // leave the order where it is rather than guess
+    OB_COLD bool level_vanished(OrderHandle) {
+        return false;
+    }
+
+    bool insert_order(const Order& order) {
+        PriceKey key = Price::to_key(order.price);
+        bool accepted = order.is_buy ? bids.accepts(key) : asks.accepts(key);
+        if (OB_UNLIKELY(!accepted)) {
+            return false;   // outside a fixed ladder's price band
+        }
+        if (OB_UNLIKELY(order.owner == OrderColumns::kNoOwner)) {
+            return false;   // reserved: marks free slots in the owner column
+        }
+
+        // allocate order from memory pool
+        OrderHandle h = order_pool.allocate(order);
+        if (OB_UNLIKELY(!order_index.insert(order.order_id, h, key_of()))) {
+            return abandon_insert(h, false);
+        }
+
+        // GTT / day orders: arm the expiry timer, rejecting ones already due
+        if (OB_UNLIKELY(order.expiry_ns != 0) &&
+            !expiry_wheel.schedule(h, order.expiry_ns, order.timestamp_ns)) {
+            return abandon_insert(h, true);
+        }
+
+        PriceLevelData& level = with_side(order.is_buy, [&](auto& side) -> PriceLevelData& {
+            return side.level(key);
+        });
+        level.add_order(order_pool, h);
+        publish_level(order.is_buy, key, level.total_quantity);
+        toggle_checksum(order);
+
+        if (use_columns) {
+            if (h >= columns.size()) {
+                columns.resize(order_pool.capacity());
+            }
+            columns.set(h, order.order_id, order.quantity, order.owner, order.expiry_ns);
+        }
+        return true;
+    }
+
+    bool erase_order(uint64_t order_id) {
+        OrderHandle h = order_index.find(order_id, key_of());
+        if (OB_UNLIKELY(h == Index::kInvalid)) {
+            return false;
+        }
+        return erase_handle(h);
+    }
+
+    // take an order out of its level's FIFO, dropping the level if emptied;
+    // false if the level is missing
+    bool unlink_from_level(OrderHandle h) {
+        const Order& order = order_pool.at(h).order;
+        PriceKey key = Price::to_key(order.price);
+        return with_side(order.is_buy, [&](auto& side) {
+            PriceLevelData* price_level = side.find(key);
+            if (OB_UNLIKELY(!price_level)) {
+                return false;
+            }
+            price_level->remove_order(order_pool, h);
+            publish_level(order.is_buy, key, price_level->total_quantity);
+            if constexpr (Config::kBranchlessLevels) {
+                side.release(key);
+            } else if (OB_UNLIKELY(price_level->empty())) {
+                side.erase(key);
+            }
+            return true;
+        });
+    }
+
+    bool erase_handle(OrderHandle h) {
+        const Order& order = order_pool.at(h).order;
+        if (OB_UNLIKELY(!unlink_from_level(h))) {
+            return level_vanished(h);
+        }
+
+        // remove from lookup, then recycle the slot
+        toggle_checksum(order);
+        if (OB_UNLIKELY(order.expiry_ns != 0)) {
+            expiry_wheel.cancel(h);
+        }
+        if (use_columns) {
+            columns.clear(h);
+        }
+        order_index.erase(order.order_id, key_of());
+        order_pool.deallocate(h);
+
+        return true;
+    }
+
+    // reprice a resting order: it leaves its level and joins the back of
+    // the level at new_price, keeping its pool slot, index entry and expiry
+    // timer. Checked before anything moves, so a rejected reprice leaves
+    // the book as it was
+    bool move_order(OrderHandle h, double new_price, uint64_t new_quantity, uint64_t timestamp_ns) {
+        Order& order = order_pool.at(h).order;
+        PriceKey new_key = Price::to_key(new_price);
+        bool accepted = with_side(order.is_buy, [&](auto& side) {
+            if (side.accepts(new_key)) {
+                return true;
+            }
+            // a ladder side holding only this order re-anchors once it leaves
+            const PriceLevelData* level = side.find(Price::to_key(order.price));
+            return side.size() == 1 && level && level->head == h && level->tail == h;
+        });
+        if (OB_UNLIKELY(new_quantity == 0 || !accepted)) {
+            return false;
+        }
+        if (OB_UNLIKELY(!unlink_from_level(h))) {
+            return level_vanished(h);
+        }
+
+        toggle_checksum(order);
+        order.price = new_price;
+        order.quantity = new_quantity;
+        if (timestamp_ns) {
+            order.timestamp_ns = timestamp_ns;
+        }
+        toggle_checksum(order);
+        if (use_columns) {
+            columns.qty[h] = new_quantity;
+        }
+
+        PriceLevelData& level = with_side(order.is_buy, [&](auto& side) -> PriceLevelData& {
+            return side.level(new_key);
+        });
+        level.add_order(order_pool, h);
+        publish_level(order.is_buy, new_key, level.total_quantity);
+        return true;
+    }
+
+    // new quantity for a resting order, keeping its place in the queue;
+    // 0 removes it
+    void set_quantity(OrderHandle h, uint64_t new_quantity) {
+        OrderNode& node = order_pool.at(h);
+        Order& order = node.order;
+        uint64_t old_qty = order.quantity;
+        toggle_checksum(order);
+        order.quantity = new_quantity;
+        toggle_checksum(order);
+        if (use_columns) {
+            columns.qty[h] = new_quantity;
+        }
+        PriceKey key = Price::to_key(order.price);
+        PriceLevelData* level = with_side(order.is_buy, [&](auto& side) {
+            return side.find(key);
+        });
+        level->update_quantity(node, old_qty);
+        if (new_quantity != 0) {
+            publish_level(order.is_buy, key, level->total_quantity);
+        }
+
+        // if quantity becomes 0, remove order
+        if (OB_UNLIKELY(new_quantity == 0)) {
+            erase_handle(h);
+        }
+    }
+
+    // events between a prefetch and its use in batched paths: far enough to
+    // cover a DRAM miss behind a few cancels, near enough that the lines are
+    // still in L1
+    static constexpr size_t kPrefetchDistance = 8;
+
+    // run op(i) for i in [0, n) with the misses of later ops in flight:
+    // while op i runs, the order node of id_of(i + kPrefetchDistance) and the
+    // index bucket of id_of(i + 2 * kPrefetchDistance) are being loaded
+    template<typename IdOf, typename Op>
+    inline void pipelined(size_t n, IdOf&& id_of, Op&& op) {
+        for (size_t i = 0; i < n && i < 2 * kPrefetchDistance; ++i) {
+            order_index.prefetch(id_of(i));
+        }
+        for (size_t i = 0; i < n && i < kPrefetchDistance; ++i) {
+            prefetch_node(id_of(i));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (OB_LIKELY(i + 2 * kPrefetchDistance < n)) {
+                order_index.prefetch(id_of(i + 2 * kPrefetchDistance));
+            }
+            if (OB_LIKELY(i + kPrefetchDistance < n)) {
+                prefetch_node(id_of(i + kPrefetchDistance));
+            }
+            op(i);
+        }
+    }
+
+    // second pipeline stage: the bucket is (ideally) cached, so its slot is
+    // cheap to read - start loading the order node it points at. The hint is
+    // unconfirmed; a wrong guess costs a wasted line, not a wrong cancel
+    inline void prefetch_node(uint64_t order_id) const {
+        OrderHandle h = order_index.hint(order_id);
+        if (h != Index::kInvalid) {
+            order_pool.prefetch(h);
+        }
+    }
+
+    // handles of resting orders matching pred, found by walking every level's
+    // FIFO - the array-of-structs path used when columns are off
+    template<typename Pred>
+    void collect_handles(Pred&& pred, std::vector<OrderHandle>& out) const {
+        auto walk = [&](const auto& side) {
+            side.walk([&](PriceKey, const PriceLevelData& level) {
+                for (OrderHandle h = level.head; h != kNullHandle; h = order_pool.at(h).next) {
+                    if (pred(order_pool.at(h).order)) out.push_back(h);
+                }
+                return true;
+            });
+        };
+        walk(bids);
+        walk(asks);
+    }
+
+public:
+    BasicOrderBook() {
+        if (Config::kExpectedOrders) {
+            reserve(Config::kExpectedOrders);
+        }
+    }
+
+    // scan_columns keeps an SoA copy of id/qty/owner/expiry so mass cancels
+    // and expiry sweeps run as vectorized column scans
+    explicit BasicOrderBook(bool scan_columns) : BasicOrderBook() {
+        use_columns = scan_columns;
+        if (use_columns) {
+            columns.resize(order_pool.capacity());
+        }
+    }
+
+    ~BasicOrderBook() {
+        if (metrics_registry) {
+            metrics_registry->release(counters);
+        }
+    }
+
+    // prevent copying
+    BasicOrderBook(const BasicOrderBook&) = delete;
+    BasicOrderBook& operator=(const BasicOrderBook&) = delete;
+
+    // size the pool and order index for an expected number of resting orders
+    void reserve(size_t expected_orders) {
+        order_pool.reserve(expected_orders);
+        order_index.reserve(expected_orders);
+    }
+
+    // export this book's counters through a registry under the given name;
+    // keeps the private block if the registry is full
+    bool attach_metrics(MetricsRegistry& registry, const char* name) {
+        BookCounters* block = registry.acquire(name);
+        if (!block) {
+            return false;
+        }
+        if (metrics_registry) {
+            metrics_registry->release(counters);
+        }
+        metrics_registry = &registry;
+        counters = block;
+        publish_gauges();
+        return true;
+    }
+
+    const BookCounters& get_counters() const {
+        return *counters;
+    }
+
+    // append a LevelDelta to sink for every level change (nullptr to stop);
+    // the caller drains it
+    void set_delta_sink(std::vector<LevelDelta>* sink) {
+        delta_sink = sink;
+    }
+
+    // insert new order into book; rejects a duplicate order_id, an id the
+    // index cannot hold, a price outside a fixed ladder's band, or the
+    // reserved owner OrderColumns::kNoOwner
+    bool add_order(const Order& order) {
+        BookCounters::bump(counters->messages);
+        if (OB_UNLIKELY(!insert_order(order))) {
+            return reject();
+        }
+        BookCounters::bump(counters->orders_added);
+        publish_gauges();
+        return true;
+    }
+
+    // re-insert a resting order when rebuilding from a snapshot: same checks
+    // as add_order, but not a message, so only the gauges move
+    bool restore_order(const Order& order) {
+        if (OB_UNLIKELY(!insert_order(order))) {
+            return false;
+        }
+        publish_gauges();
+        return true;
+    }
+
+    // cancel existing order by ID
+    bool cancel_order(uint64_t order_id) {
+        BookCounters::bump(counters->messages);
+        if (OB_UNLIKELY(!erase_order(order_id))) {
+            return reject();
+        }
+        BookCounters::bump(counters->orders_canceled);
+        publish_gauges();
+        return true;
+    }
+
+    // cancel a burst of orders by ID, in order; returns how many were
+    // resting. Each cancel is a chain of dependent misses (index bucket ->
+    // order node -> its level and FIFO neighbours), so the burst is
+    // software-pipelined (see pipelined())
+    size_t cancel_orders(const uint64_t* order_ids, size_t n) {
+        size_t canceled = 0;
+        pipelined(n, [order_ids](size_t i) { return order_ids[i]; }, [&](size_t i) {
+            canceled += cancel_order(order_ids[i]);
+        });
+        return canceled;
+    }
+
+    // amend existing order's price or quantity. A reprice loses priority:
+    // the order joins the back of its new level, and takes timestamp_ns as
+    // its entry time when one is given. Quantity 0 at the same price removes
+    // the order; a rejected amend leaves the book unchanged
+    bool amend_order(uint64_t order_id, double new_price, uint64_t new_quantity, uint64_t timestamp_ns = 0) {
+        BookCounters::bump(counters->messages);
+        OrderHandle h = order_index.find(order_id, key_of());
+        if (OB_UNLIKELY(h == Index::kInvalid)) {
+            return reject();
+        }
+
+        Order& order = order_pool.at(h).order;
+
+        // if the price level changes the order moves to the back of the new
+        // level; rejected (book unchanged) for a price outside a ladder's
+        // band or a quantity of 0
+        if (Price::to_key(order.price) != Price::to_key(new_price)) {
+            if (OB_UNLIKELY(!move_order(h, new_price, new_quantity, timestamp_ns))) {
+                return reject();
+            }
+        } else {
+            // only quantity changes - update in place
+            set_quantity(h, new_quantity);
+        }
+
+        BookCounters::bump(counters->orders_amended);
+        publish_gauges();
+        return true;
+    }
+
+    // trade against a resting order: take quantity off it in place (it
+    // keeps its queue position), removing it once fully filled
+    bool execute_order(uint64_t order_id, uint64_t quantity) {
+        BookCounters::bump(counters->messages);
+        OrderHandle h = order_index.find(order_id, key_of());
+        if (OB_UNLIKELY(h == Index::kInvalid)) {
+            return reject();
+        }
+
+        uint64_t resting = order_pool.at(h).order.quantity;
+        set_quantity(h, quantity < resting ? resting - quantity : 0);
+
+        BookCounters::bump(counters->orders_executed);
+        publish_gauges();
+        return true;
+    }
+
+    // dispatch one recorded input message
+    bool apply(const OrderEvent& ev) {
+        switch (ev.type) {
+        case EventType::Add:
+            return add_order(ev.to_order());
+        case EventType::Cancel:
+            return cancel_order(ev.order_id);
+        case EventType::Amend:
+            return amend_order(ev.order_id, ev.price, ev.quantity, ev.timestamp_ns);
+        case EventType::Execute:
+            return execute_order(ev.order_id, ev.quantity);
+        }
+        return false;
+    }
+
+    // apply a batch of events (a burst off the input queue) in order, with
+    // the same pipelined prefetching as cancel_orders; returns how many were
+    // accepted. Events are not regrouped by level: that would reorder queue
+    // priority. With a delta sink set, the batch publishes one LevelDelta per
+    // level it touched, carrying the level's quantity after the batch (0 if
+    // gone), in first-touch order at the end instead of one per event
+    size_t apply(const OrderEvent* events, size_t n) {
+        batching = delta_sink != nullptr;
+        size_t accepted = 0;
+        pipelined(n, [events](size_t i) { return events[i].order_id; }, [&](size_t i) {
+            accepted += apply(events[i]);
+        });
+        if (batching) {
+            batching = false;
+            flush_touched();
+        }
+        return accepted;
+    }
+
+    // remove every order whose expiry_ns <= now_ns; call once per book loop.
+    // Cost is proportional to the orders that expire, not to the book size
+    size_t expire_orders(uint64_t now_ns) {
+        size_t expired = expiry_wheel.advance(now_ns, [this](OrderHandle h) {
+            erase_handle(h);
+        });
+        if (OB_UNLIKELY(expired)) {
+            BookCounters::bump(counters->orders_expired, expired);
+            publish_gauges();
+        }
+        return expired;
+    }
+
+    // cancel every resting order of one owner; returns the number removed
+    size_t cancel_all_for_owner(uint32_t owner) {
+        std::vector<OrderHandle> hits;
+        if (use_columns) {
+            // free slots carry kNoOwner, and no resting order can
+            if (owner != OrderColumns::kNoOwner) {
+                columns.find_owner(owner, hits);
+            }
+        } else {
+            collect_handles([owner](const Order& o) { return o.owner == owner; }, hits);
+        }
+        for (OrderHandle h : hits) {
+            erase_handle(h);
+        }
+        BookCounters::bump(counters->messages);
+        BookCounters::bump(counters->orders_canceled, hits.size());
+        publish_gauges();
+        return hits.size();
+    }
+
+    // ids of resting orders whose expiry_ns <= now_ns (audit; does not remove)
+    void get_expired_orders(uint64_t now_ns, std::vector<uint64_t>& ids_out) const {
+        std::vector<OrderHandle> hits;
+        if (use_columns) {
+            columns.find_expired(now_ns, hits);
+        } else {
+            collect_handles([now_ns](const Order& o) {
+                return o.expiry_ns != 0 && o.expiry_ns <= now_ns;
+            }, hits);
+        }
+        ids_out.clear();
+        for (OrderHandle h : hits) {
+            ids_out.push_back(use_columns ? columns.ids[h] : order_pool.at(h).order.order_id);
+        }
+    }
+
+    // total resting quantity of one owner
+    uint64_t get_owner_quantity(uint32_t owner) const {
+        if (use_columns) {
+            // free slots carry kNoOwner, and no resting order can
+            return owner != OrderColumns::kNoOwner ? columns.owner_quantity(owner) : 0;
+        }
+        uint64_t total = 0;
+        std::vector<OrderHandle> hits;
+        collect_handles([owner](const Order& o) { return o.owner == owner; }, hits);
+        for (OrderHandle h : hits) {
+            total += order_pool.at(h).order.quantity;
+        }
+        return total;
+    }
+
+    // get a snapshot of top N bid and ask levels
+    void get_snapshot(size_t depth, std::vector<PriceLevel>& bids_out, std::vector<PriceLevel>& asks_out) const {
+        bids_out.clear();
+        asks_out.clear();
+        bids_out.reserve(depth);
+        asks_out.reserve(depth);
+
+        // sides walk best price first
+        auto top = [depth](const auto& side, std::vector<PriceLevel>& out) {
+            if (depth == 0) return;
+            side.walk([&](PriceKey key, const PriceLevelData& level) {
+                out.emplace_back(Price::to_price(key), level.total_quantity);
+                return out.size() < depth;
+            });
+        };
+        top(bids, bids_out);
+        top(asks, asks_out);
+    }
+
+    // every resting order (L3): bids then asks, best level first and FIFO
+    // within a level, so adding them in this order to an empty book rebuilds
+    // it with the same queue priority
+    void get_orders(std::vector<Order>& out) const {
+        out.clear();
+        out.reserve(order_index.size());
+        auto walk = [&](const auto& side) {
+            side.walk([&](PriceKey, const PriceLevelData& level) {
+                for (OrderHandle h = level.head; h != kNullHandle; h = order_pool.at(h).next) {
+                    out.push_back(order_pool.at(h).order);
+                }
+                return true;
+            });
+        };
+        walk(bids);
+        walk(asks);
+    }
+
+    // a resting order by id, nullptr if there is none; valid until the next
+    // mutation
+    const Order* find_order(uint64_t order_id) const {
+        OrderHandle h = order_index.find(order_id, key_of());
+        return h == Index::kInvalid ? nullptr : &order_pool.at(h).order;
+    }
+
+    // f(price, total_quantity) for one side's levels, best first, until f
+    // returns false
+    template<typename F>
+    void walk_levels(bool is_buy, F&& f) const {
+        auto visit = [&](PriceKey key, const PriceLevelData& level) {
+            return f(Price::to_price(key), level.total_quantity);
+        };
+        if (is_buy) {
+            bids.walk(visit);
+        } else {
+            asks.walk(visit);
+        }
+    }
+
+    // aggregate resting quantity at one price, 0 if there is no such level
+    uint64_t level_quantity(bool is_buy, double price) const {
+        PriceKey key = Price::to_key(price);
+        const PriceLevelData* level = is_buy ? bids.find(key) : asks.find(key);
+        return level ? level->total_quantity : 0;
+    }
+
+    // best bid and ask (quantity 0 for an empty side)
+    TopOfBook get_top() const {
+        TopOfBook top;
+        bids.walk([&](PriceKey key, const PriceLevelData& level) {
+            top.bid = PriceLevel(Price::to_price(key), level.total_quantity);
+            return false;
+        });
+        asks.walk([&](PriceKey key, const PriceLevelData& level) {
+            top.ask = PriceLevel(Price::to_price(key), level.total_quantity);
+            return false;
+        });
+        return top;
+    }
+
+    // print current state of order book
+    void print_book(size_t depth = 10) const {
+        std::vector<PriceLevel> bids_snapshot, asks_snapshot;
+        get_snapshot(depth, bids_snapshot, asks_snapshot);
+
+        std::cout << "\n" << std::string(50, '=') << "\n";
+        std::cout << "ORDER BOOK (Top " << depth << " levels)\n";
+        std::cout << std::string(50, '=') << "\n\n";
+
+        std::cout << std::setw(15) << "BIDS" << " | " << std::setw(15) << "ASKS" << "\n";
+        std::cout << std::setw(8) << "Price" << " " << std::setw(6) << "Qty"
+                  << " | " << std::setw(8) << "Price" << " " << std::setw(6) << "Qty" << "\n";
+        std::cout << std::string(50, '-') << "\n";
+
+        size_t max_levels = std::max(bids_snapshot.size(), asks_snapshot.size());
+        for (size_t i = 0; i < max_levels; ++i) {
+            // print bid
+            if (i < bids_snapshot.size()) {
+                std::cout << std::fixed << std::setprecision(2)
+                         << std::setw(8) << bids_snapshot[i].price << " "
+                         << std::setw(6) << bids_snapshot[i].total_quantity;
+            } else {
+                std::cout << std::setw(15) << " ";
+            }
+
+            std::cout << " | ";
+
+            // print ask
+            if (i < asks_snapshot.size()) {
+                std::cout << std::fixed << std::setprecision(2)
+                         << std::setw(8) << asks_snapshot[i].price << " "
+                         << std::setw(6) << asks_snapshot[i].total_quantity;
+            }
+
+            std::cout << "\n";
+        }
+
+        std::cout << std::string(50, '=') << "\n";
+
+        // print spread
+        if (!bids_snapshot.empty() && !asks_snapshot.empty()) {
+            double spread = asks_snapshot[0].price - bids_snapshot[0].price;
+            std::cout << "Spread: " << std::fixed << std::setprecision(2) << spread << "\n";
+        }
+
+        std::cout << std::string(50, '=') << "\n\n";
+    }
+
+    // incremental checksum of the resting orders: equal for books holding the
+    // same orders, whatever their config (needs Config::kChecksum). Blind to
+    // queue order within a level; diff_books in book_diff.h checks that
+    uint64_t get_checksum() const {
+        static_assert(Config::kChecksum, "get_checksum needs a WithChecksum<...> config");
+        return checksum;
+    }
+
+    // utility functions for testing
+    size_t get_total_orders() const {
+        return order_index.size();
+    }
+
+    // bytes held by the id index (excludes the order records themselves)
+    size_t get_index_memory() const {
+        return order_index.memory_bytes();
+    }
+
+    size_t get_bid_levels() const {
+        return bids.size();
+    }
+
+    size_t get_ask_levels() const {
+        return asks.size();
+    }
+};
+
+using OrderBook = BasicOrderBook<DefaultConfig>;
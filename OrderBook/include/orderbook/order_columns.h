@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Structure-of-arrays copy of the order fields that bulk operations scan
+// (mass cancel by owner, expiry sweeps, audits). Columns are indexed by the
+// same 32-bit handle as the pool, so a scan streams 4-8 bytes per order
+// instead of dragging whole order records through cache.
+//
+// Free slots hold sentinels that never match a predicate: owner kNoOwner and
+// expiry kNoExpiry, with quantity 0 so they add nothing to a sum. Expiries are kept below 2^63 so the AVX2 kernels can use
+// the signed 64-bit compare.
+class OrderColumns {
+public:
+    static constexpr uint32_t kNoOwner = UINT32_MAX;
+    static constexpr int64_t kNoExpiry = INT64_MAX;
+
+    std::vector<uint64_t> ids;
+    std::vector<uint64_t> qty;
+    std::vector<uint32_t> owner;
+    std::vector<int64_t> expiry;
+
+    size_t size() const { return ids.size(); }
+
+    // grow to cover handles [0, n); n is kept a multiple of 8 for the kernels
+    void resize(size_t n) {
+        n = (n + 7) & ~size_t(7);
+        if (n <= ids.size()) return;
+        ids.resize(n, 0);
+        qty.resize(n, 0);
+        owner.resize(n, kNoOwner);
+        expiry.resize(n, kNoExpiry);
+    }
+
+    inline void set(uint32_t h, uint64_t id, uint64_t q, uint32_t own, uint64_t expiry_ns) {
+        ids[h] = id;
+        qty[h] = q;
+        owner[h] = own;
+        expiry[h] = (expiry_ns == 0 || expiry_ns >= uint64_t(kNoExpiry)) ? kNoExpiry : int64_t(expiry_ns);
+    }
+
+    inline void clear(uint32_t h) {
+        qty[h] = 0;
+        owner[h] = kNoOwner;
+        expiry[h] = kNoExpiry;
+    }
+
+    // append handles whose owner == own
+    void find_owner(uint32_t own, std::vector<uint32_t>& out) const {
+        size_t n = owner.size();
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i needle = _mm256_set1_epi32(int32_t(own));
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&owner[i]));
+            unsigned mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle))));
+            while (mask) {
+                out.push_back(uint32_t(i + __builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            if (owner[i] == own) out.push_back(uint32_t(i));
+        }
+    }
+
+    // append handles whose expiry <= now_ns
+    void find_expired(uint64_t now_ns, std::vector<uint32_t>& out) const {
+        if (now_ns >= uint64_t(kNoExpiry)) now_ns = uint64_t(kNoExpiry) - 1;
+        const int64_t now = int64_t(now_ns);
+        size_t n = expiry.size();
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i limit = _mm256_set1_epi64x(now);
+        for (; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&expiry[i]));
+            // expired lanes are the ones NOT greater than now
+            unsigned mask = ~unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, limit)))) & 0xFu;
+            while (mask) {
+                out.push_back(uint32_t(i + __builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            if (expiry[i] <= now) out.push_back(uint32_t(i));
+        }
+    }
+
+    // total resting quantity of one owner (audit / exposure check)
+    uint64_t owner_quantity(uint32_t own) const {
+        size_t n = owner.size();
+        size_t i = 0;
+        uint64_t total = 0;
+#if defined(__AVX2__)
+        const __m256i needle = _mm256_set1_epi32(int32_t(own));
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 4 <= n; i += 4) {
+            // widen 4 owner lanes to 64 bits to mask the 4 matching qty lanes
+            __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&owner[i]));
+            __m256i eq = _mm256_cvtepi32_epi64(_mm_cmpeq_epi32(o, _mm256_castsi256_si128(needle)));
+            __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&qty[i]));
+            acc = _mm256_add_epi64(acc, _mm256_and_si256(q, eq));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; i < n; ++i) {
+            if (owner[i] == own) total += qty[i];
+        }
+        return total;
+    }
+};
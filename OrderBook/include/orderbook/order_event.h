@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "orderbook/order.h"
+
+enum class EventType : uint8_t {
+    Add = 0,
+    Cancel = 1,
+    Amend = 2,
+    Execute = 3,    // trade against a resting order: quantity filled at price
+};
+
+// One book input message as recorded in replay files. Fixed 48-byte layout so
+// files can be read (and later mapped) as plain arrays.
+struct OrderEvent {
+    uint64_t timestamp_ns;
+    uint64_t order_id;
+    double price;           // Add / Amend / Execute
+    uint64_t quantity;      // Add / Amend / Execute
+    uint64_t expiry_ns;     // Add, 0 = good till cancel
+    uint32_t owner;         // Add
+    EventType type;
+    bool is_buy;            // Add
+    uint8_t reserved[2];
+
+    static OrderEvent add(const Order& o) {
+        return OrderEvent{o.timestamp_ns, o.order_id, o.price, o.quantity,
+                          o.expiry_ns, o.owner, EventType::Add, o.is_buy, {0, 0}};
+    }
+
+    static OrderEvent cancel(uint64_t id, uint64_t ts) {
+        return OrderEvent{ts, id, 0.0, 0, 0, 0, EventType::Cancel, false, {0, 0}};
+    }
+
+    static OrderEvent amend(uint64_t id, double price, uint64_t qty, uint64_t ts) {
+        return OrderEvent{ts, id, price, qty, 0, 0, EventType::Amend, false, {0, 0}};
+    }
+
+    static OrderEvent execute(uint64_t id, double price, uint64_t qty, uint64_t ts) {
+        return OrderEvent{ts, id, price, qty, 0, 0, EventType::Execute, false, {0, 0}};
+    }
+
+    Order to_order() const {
+        return Order(order_id, is_buy, price, quantity, timestamp_ns, owner, expiry_ns);
+    }
+};
+
+static_assert(sizeof(OrderEvent) == 48, "OrderEvent is a file format record");
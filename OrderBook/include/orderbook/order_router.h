@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "orderbook/consolidated_book.h"
+
+// Per-venue taker fees in price units per unit filled (negative = rebate).
+struct VenueFees {
+    std::array<double, ConsolidatedBook::kMaxVenues> take_fee{};
+};
+
+// one child order: take quantity at price on venue
+struct RouteSlice {
+    uint32_t venue;
+    double price;
+    uint64_t quantity;
+};
+
+struct RouteResult {
+    size_t slices = 0;      // entries written to the output buffer
+    uint64_t filled = 0;    // quantity routed
+    double notional = 0.0;  // sum of price * quantity
+    double fees = 0.0;      // sum of fee * quantity
+};
+
+// Smart order router over a consolidated book: splits an aggressive order
+// across venues to minimize price + fees. Each (level, venue) pair is a
+// candidate with a per-unit effective price (price + fee for buys, price -
+// fee for sells); taking candidates best effective price first is optimal
+// because every unit's cost is independent.
+//
+// Only levels that can matter are visited: once the walk has seen enough
+// quantity at raw price P, a level worse than P by more than the widest fee
+// difference cannot beat what is already collected. Candidates live in a
+// fixed member array and slices go to the caller's buffer, so route() never
+// allocates. Past MaxCandidates the walk stops early (the result is then
+// best among those seen).
+template<size_t MaxCandidates = 256>
+class OrderRouter {
+private:
+    struct Candidate {
+        double score;       // effective cost per unit, lower is better
+        double price;
+        uint64_t quantity;
+        uint32_t venue;
+    };
+
+    VenueFees fees;
+    double min_fee;
+    double max_fee;
+    std::array<Candidate, MaxCandidates> candidates;
+
+public:
+    explicit OrderRouter(const VenueFees& venue_fees) : fees(venue_fees) {
+        min_fee = max_fee = fees.take_fee[0];
+        for (double f : fees.take_fee) {
+            min_fee = f < min_fee ? f : min_fee;
+            max_fee = f > max_fee ? f : max_fee;
+        }
+    }
+
+    // route quantity against the opposite side of book, taking no level
+    // priced worse than limit_price; writes at most max_slices slices
+    template<typename Config>
+    RouteResult route(const BasicConsolidatedBook<Config>& book, bool is_buy, uint64_t quantity,
+                      double limit_price, RouteSlice* out, size_t max_slices) {
+        // work in "badness" b = price for buys, -price for sells: the
+        // opposite side walks in increasing b and score = b + fee
+        const double sign = is_buy ? 1.0 : -1.0;
+        const double b_limit = sign * limit_price;
+
+        size_t n = 0;
+        uint64_t seen = 0;
+        double threshold = 0.0;     // valid once seen >= quantity
+        book.walk(!is_buy, [&](double price, const auto& level) {
+            double b = sign * price;
+            if (b > b_limit) return false;
+            if (seen >= quantity && b + min_fee > threshold) return false;
+
+            for (uint32_t mask = level.venue_mask; mask; mask &= mask - 1) {
+                if (n == MaxCandidates) return false;
+                uint32_t v = static_cast<uint32_t>(__builtin_ctz(mask));
+                candidates[n++] = Candidate{b + fees.take_fee[v], price, level.venue_quantity[v], v};
+            }
+            if (seen < quantity) {
+                seen += level.total_quantity;
+                if (seen >= quantity) threshold = b + max_fee;
+            }
+            return true;
+        });
+
+        // insertion sort: n is small and mostly ordered already
+        for (size_t i = 1; i < n; ++i) {
+            Candidate c = candidates[i];
+            size_t j = i;
+            for (; j > 0 && candidates[j - 1].score > c.score; --j) candidates[j] = candidates[j - 1];
+            candidates[j] = c;
+        }
+
+        RouteResult result;
+        for (size_t i = 0; i < n && result.filled < quantity && result.slices < max_slices; ++i) {
+            const Candidate& c = candidates[i];
+            uint64_t take = quantity - result.filled < c.quantity ? quantity - result.filled : c.quantity;
+            out[result.slices++] = RouteSlice{c.venue, c.price, take};
+            result.filled += take;
+            result.notional += c.price * double(take);
+            result.fees += fees.take_fee[c.venue] * double(take);
+        }
+        return result;
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "orderbook/compiler.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/spsc_queue.h"
+
+// Hands pooled objects (orders, events) from the thread that allocates them
+// (a gateway) to the thread that consumes and frees them (the book), with
+// no lock and nothing shared per object beyond the handoff itself.
+//
+// MemoryPool is single-threaded, so the pool stays owned by the gateway:
+// only the gateway allocates and deallocates. The book thread reads slots
+// through their handles and, when done with one, returns the handle. Returns
+// are collected in a local batch and published kReturnBatch at a time
+// through an SpscQueue of batches; the gateway drains that queue back into
+// its free list when it runs out of slots (or calls reclaim()). Per object
+// each side then touches only its own cursor and buffer; the return ring's
+// cursors move once per batch.
+//
+// The pool is sized up front and never grows: a growing slab table would
+// be rewritten under the book thread's reads. allocate() returns
+// kNullHandle while every slot is in flight - back-pressure from a book
+// that has fallen behind, or one holding returns in a partial batch (it
+// should flush() when idle).
+//
+// Handles go forward one at a time (send() publishes at once, since
+// batching there would add latency to every order). A handle is published
+// with release ordering after its object is written, and returned after
+// the book's last read of it, so each slot is only ever touched by one
+// thread at a time.
+template<typename T, size_t BlockSize = 4096>
+class PoolHandoff {
+public:
+    using Pool = MemoryPool<T, BlockSize>;
+    using Handle = typename Pool::Handle;
+    static constexpr Handle kNullHandle = Pool::kNullHandle;
+
+    // handles per return batch: 64 x 4 bytes with the count, four cache lines
+    static constexpr size_t kReturnBatch = 63;
+
+    explicit PoolHandoff(size_t capacity)
+        : forward(slots_for(capacity)), returns(slots_for(capacity) / kReturnBatch + 64) {
+        pool.reserve(slots_for(capacity));
+    }
+
+    PoolHandoff(const PoolHandoff&) = delete;
+    PoolHandoff& operator=(const PoolHandoff&) = delete;
+
+    // ---- owner (gateway) thread ----
+
+    // construct an object in a free slot, reclaiming returned slots first if
+    // none are left; kNullHandle when all of them are still in flight
+    template<typename... Args>
+    Handle allocate(Args&&... args) {
+        if (OB_UNLIKELY(pool.full()) && reclaim() == 0) {
+            return kNullHandle;
+        }
+        return pool.allocate(std::forward<Args>(args)...);
+    }
+
+    T& at(Handle h) { return pool.at(h); }
+
+    // pass an allocated object to the book thread
+    void send(Handle h) {
+        // cannot fill: the ring holds every slot the pool has
+        forward.push(h);
+    }
+
+    // free a slot the gateway allocated but never sent
+    void discard(Handle h) {
+        pool.deallocate(h);
+    }
+
+    // drain returned batches into the pool's free list; returns slots freed
+    size_t reclaim() {
+        size_t freed = 0;
+        ReturnBatch batch;
+        while (returns.pop(batch)) {
+            for (uint32_t i = 0; i < batch.count; ++i) {
+                pool.deallocate(batch.handles[i]);
+            }
+            freed += batch.count;
+        }
+        return freed;
+    }
+
+    // slots allocated and not yet reclaimed (sent, held or returned)
+    size_t in_use() const { return pool.size(); }
+    size_t capacity() const { return pool.capacity(); }
+
+    // ---- book thread ----
+
+    // next handed-over object, or false if none is waiting
+    bool receive(Handle& h) {
+        return forward.pop(h);
+    }
+
+    const T& get(Handle h) const { return pool.at(h); }
+
+    // done with a received object; its slot goes back to the gateway with
+    // the next full batch
+    void release(Handle h) {
+        pending.handles[pending.count++] = h;
+        if (OB_UNLIKELY(pending.count == kReturnBatch)) {
+            flush();
+        }
+    }
+
+    // f(object) for every object waiting, releasing each after f returns;
+    // returns how many were consumed
+    template<typename F>
+    size_t consume(F&& f) {
+        size_t n = 0;
+        for (Handle h; forward.pop(h); ++n) {
+            f(static_cast<const T&>(pool.at(h)));
+            release(h);
+        }
+        return n;
+    }
+
+    // publish a partial return batch (call when the book goes idle)
+    void flush() {
+        if (OB_UNLIKELY(!backlog.empty())) {
+            drain_backlog();
+        }
+        if (pending.count == 0) {
+            return;
+        }
+        if (OB_UNLIKELY(!backlog.empty() || !returns.push(pending))) {
+            backlog.push_back(pending);
+        }
+        pending.count = 0;
+    }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    // the pool's capacity once reserved: whole slabs, at least one
+    static size_t slots_for(size_t capacity) {
+        size_t slabs = (capacity + Pool::kSlotsPerBlock - 1) / Pool::kSlotsPerBlock;
+        return (slabs ? slabs : 1) * Pool::kSlotsPerBlock;
+    }
+
+    struct ReturnBatch {
+        uint32_t count = 0;
+        Handle handles[kReturnBatch];
+    };
+
+    // batches the return ring had no room for (many partial flushes while
+    // the gateway was not reclaiming), republished in order
+    OB_COLD void drain_backlog() {
+        size_t sent = 0;
+        while (sent < backlog.size() && returns.push(backlog[sent])) ++sent;
+        backlog.erase(backlog.begin(), backlog.begin() + sent);
+    }
+
+    // gateway only (the book reads the slab table, fixed after construction)
+    Pool pool;
+
+    alignas(kCacheLine) SpscQueue<Handle> forward;
+    alignas(kCacheLine) SpscQueue<ReturnBatch> returns;
+
+    // book thread only
+    alignas(kCacheLine) ReturnBatch pending;
+    std::vector<ReturnBatch> backlog;
+};
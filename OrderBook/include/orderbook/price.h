@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Price policies: how an order's double price becomes the key its level is
+// stored under. Orders always carry the double; only the side containers
+// see keys.
+
+// key = the double itself (any price is accepted as its own level)
+struct DoublePrice {
+    using Key = double;
+
+    static constexpr bool kIntegral = false;
+
+    static inline Key to_key(double price) { return price; }
+    static inline double to_price(Key key) { return key; }
+};
+
+// fixed-point ticks: key = round(price * kTicksPerUnit), e.g. TickPrice<100>
+// for a 0.01 tick. Prices off the grid snap to the nearest tick
+template<int64_t TicksPerUnit>
+struct TickPrice {
+    static_assert(TicksPerUnit > 0, "tick count must be positive");
+
+    using Key = int64_t;
+
+    static constexpr bool kIntegral = true;
+    static constexpr int64_t kTicksPerUnit = TicksPerUnit;
+
+    static inline Key to_key(double price) { return std::llround(price * double(kTicksPerUnit)); }
+    static inline double to_price(Key key) { return double(key) / double(kTicksPerUnit); }
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "orderbook/order_event.h"
+
+// Binary replay file: a 24-byte header followed by raw OrderEvent records.
+//
+//   char     magic[8]     "OBRPLY01"
+//   uint32_t record_size  sizeof(OrderEvent)
+//   uint32_t reserved
+//   uint64_t count        number of records (patched on close)
+struct ReplayHeader {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+static_assert(sizeof(ReplayHeader) == 24, "ReplayHeader is a file format header");
+
+constexpr char kReplayMagic[8] = {'O', 'B', 'R', 'P', 'L', 'Y', '0', '1'};
+
+class ReplayWriter {
+public:
+    ReplayWriter() = default;
+    explicit ReplayWriter(const std::string& path) { open(path); }
+    ~ReplayWriter() { close(); }
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        count = 0;
+        ReplayHeader header = make_header(0);
+        return std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    bool write(const OrderEvent& ev) {
+        if (std::fwrite(&ev, sizeof(ev), 1, file) != 1) return false;
+        ++count;
+        return true;
+    }
+
+    bool write(const OrderEvent* events, size_t n) {
+        if (std::fwrite(events, sizeof(OrderEvent), n, file) != n) return false;
+        count += n;
+        return true;
+    }
+
+    // patch the record count into the header
+    bool close() {
+        if (!file) return true;
+        ReplayHeader header = make_header(count);
+        bool ok = std::fseek(file, 0, SEEK_SET) == 0 &&
+                  std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    bool is_open() const { return file != nullptr; }
+    uint64_t size() const { return count; }
+
+private:
+    static ReplayHeader make_header(uint64_t n) {
+        ReplayHeader header{};
+        std::memcpy(header.magic, kReplayMagic, sizeof(header.magic));
+        header.record_size = sizeof(OrderEvent);
+        header.count = n;
+        return header;
+    }
+
+    FILE* file = nullptr;
+    uint64_t count = 0;
+};
+
+// Sequential reader: events are pulled in blocks into a reusable buffer.
+class ReplayReader {
+public:
+    static constexpr size_t kBatch = 4096;
+
+    ReplayReader() = default;
+    explicit ReplayReader(const std::string& path) { open(path); }
+    ~ReplayReader() { close(); }
+
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+            std::memcmp(header.magic, kReplayMagic, sizeof(kReplayMagic)) != 0 ||
+            header.record_size != sizeof(OrderEvent)) {
+            close();
+            return false;
+        }
+        remaining = header.count;
+        buffer.resize(kBatch);
+        return true;
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+    }
+
+    // next block of events, empty at end of file
+    const OrderEvent* next_batch(size_t& n) {
+        n = 0;
+        if (!file || remaining == 0) return nullptr;
+        size_t want = remaining < kBatch ? size_t(remaining) : kBatch;
+        n = std::fread(buffer.data(), sizeof(OrderEvent), want, file);
+        remaining -= n;
+        if (n < want) remaining = 0;   // truncated file
+        return buffer.data();
+    }
+
+    bool is_open() const { return file != nullptr; }
+    uint64_t size() const { return header.count; }
+
+    // load a whole file; returns false if it cannot be read
+    static bool read_all(const std::string& path, std::vector<OrderEvent>& out) {
+        ReplayReader reader;
+        if (!reader.open(path)) return false;
+        out.clear();
+        out.reserve(size_t(reader.size()));
+        size_t n;
+        while (const OrderEvent* batch = reader.next_batch(n)) {
+            if (n == 0) break;
+            out.insert(out.end(), batch, batch + n);
+        }
+        return out.size() == reader.size();
+    }
+
+private:
+    FILE* file = nullptr;
+    ReplayHeader header{};
+    uint64_t remaining = 0;
+    std::vector<OrderEvent> buffer;
+};
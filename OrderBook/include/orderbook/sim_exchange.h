@@ -0,0 +1,509 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "orderbook/compiler.h"
+#include "orderbook/order_book.h"
+#include "orderbook/order_event.h"
+
+// Latency distribution of one message path, in nanoseconds.
+class LatencyModel {
+public:
+    LatencyModel() = default;
+
+    static LatencyModel fixed(uint64_t ns) {
+        LatencyModel m;
+        m.base = ns;
+        return m;
+    }
+
+    static LatencyModel uniform(uint64_t lo_ns, uint64_t hi_ns) {
+        LatencyModel m;
+        m.kind = Kind::Uniform;
+        m.base = lo_ns;
+        m.span = hi_ns > lo_ns ? hi_ns - lo_ns : 0;
+        return m;
+    }
+
+    // floor + median * exp(sigma * N(0, 1)): the right-skewed shape of a
+    // network path with a hard minimum
+    static LatencyModel lognormal(uint64_t floor_ns, uint64_t median_ns, double sigma) {
+        LatencyModel m;
+        m.kind = Kind::LogNormal;
+        m.base = floor_ns;
+        m.median = double(median_ns);
+        m.sigma = sigma;
+        return m;
+    }
+
+    // resample measured latencies
+    static LatencyModel empirical(std::vector<uint64_t> samples_ns) {
+        LatencyModel m;
+        m.kind = samples_ns.empty() ? Kind::Fixed : Kind::Empirical;
+        m.samples = std::move(samples_ns);
+        return m;
+    }
+
+    template<typename Rng>
+    uint64_t sample(Rng& rng) const {
+        switch (kind) {
+        case Kind::Fixed:
+            return base;
+        case Kind::Uniform:
+            return base + (span ? rng() % (span + 1) : 0);
+        case Kind::LogNormal: {
+            std::normal_distribution<double> z;
+            return base + uint64_t(std::llround(median * std::exp(sigma * z(rng))));
+        }
+        case Kind::Empirical:
+            return samples[rng() % samples.size()];
+        }
+        return base;
+    }
+
+private:
+    enum class Kind : uint8_t { Fixed, Uniform, LogNormal, Empirical };
+
+    Kind kind = Kind::Fixed;
+    uint64_t base = 0;
+    uint64_t span = 0;
+    double median = 0.0;
+    double sigma = 0.0;
+    std::vector<uint64_t> samples;
+};
+
+// strategy -> venue, venue -> strategy market data, venue -> strategy reports
+struct SimLatency {
+    LatencyModel order_entry;
+    LatencyModel market_data;
+    LatencyModel reports;
+};
+
+enum class SimReportKind : uint8_t {
+    Ack,        // order reached the venue
+    Fill,
+    Canceled,
+    Rejected,   // cancel arrived after the order was done
+};
+
+// execution report as the strategy receives it
+struct SimReport {
+    SimReportKind kind;
+    bool is_buy;
+    uint64_t order_id;
+    double price;           // Fill: execution price, else the order's limit
+    uint64_t quantity;      // Fill: filled now, Canceled: quantity removed
+    uint64_t leaves;        // open quantity after this report
+    uint64_t venue_ns;      // when it happened at the venue
+    uint64_t local_ns;      // when the strategy sees it
+};
+
+struct SimStats {
+    uint64_t orders = 0;
+    uint64_t fills = 0;
+    uint64_t filled_quantity = 0;
+    uint64_t canceled = 0;
+    uint64_t rejected = 0;
+};
+
+// Simulated venue for backtests: replays historical events through the
+// book and lets a strategy's own orders interact with that flow, each
+// message delayed by its path's LatencyModel.
+//
+// Our orders are virtual: they never enter the replayed book, so historical
+// events stay consistent with it (and the flow is not impacted by our
+// trading). An order arriving at the venue first takes liquidity from the
+// opposite side up to its limit, then rests behind the quantity already at
+// its level. Its queue position is the historical quantity ahead of it,
+// worked down by events on the book's own clock:
+//
+//   cancel / amend down / reprice away of an order that was there before us
+//       -> less ahead (an order's entry time decides; repriced orders get
+//          the amend time, as they rejoin at the back)
+//   execute at our level                -> ahead first, and us once the
+//                                          trade is behind us in the queue
+//   execute at a worse price, or an add / reprice that crosses us
+//                                       -> we trade first, at our price
+//
+// Historical orders that expire are not tracked as leaving (the position
+// is then conservative). Liquidity we take stays in the book (our trades
+// are virtual too), so the venue remembers how much of each level it has
+// taken and offers only the rest, until a historical event changes that
+// level's quantity.
+//
+// Each path is a FIFO channel: a sampled latency never lets a message
+// overtake the one sent before it on the same path. Historical events at
+// time t are processed before anything arriving at t.
+//
+// The strategy is any type with
+//
+//   void on_market(const OrderEvent& ev, uint64_t local_ns);   // market data
+//   void on_report(const SimReport& r);                        // our orders
+//
+// and may call submit() / cancel() from either, stamped with local_ns.
+template<typename Config>
+class BasicSimExchange {
+public:
+    using Book = BasicOrderBook<Config>;
+
+    explicit BasicSimExchange(const SimLatency& paths = SimLatency(), uint64_t seed = 1)
+        : latency(paths), rng(seed) {}
+
+    BasicSimExchange(const BasicSimExchange&) = delete;
+    BasicSimExchange& operator=(const BasicSimExchange&) = delete;
+
+    // send a limit order at local time local_ns; returns its id (ids are
+    // ours, separate from the historical ones)
+    uint64_t submit(bool is_buy, double price, uint64_t quantity, uint64_t local_ns) {
+        orders.push_back(SimOrder{price, quantity, quantity, 0, 0, is_buy, OrderState::InFlight});
+        uint64_t id = orders.size();
+        requests.push(Request{requests.stamp(local_ns, latency.order_entry, rng), id, false});
+        ++counts.orders;
+        return id;
+    }
+
+    // send a cancel; answered with Canceled, or Rejected if it arrives late
+    bool cancel(uint64_t order_id, uint64_t local_ns) {
+        if (order_id == 0 || order_id > orders.size()) return false;
+        requests.push(Request{requests.stamp(local_ns, latency.order_entry, rng), order_id, true});
+        return true;
+    }
+
+    // replay historical events (time-sorted; a session may be fed in
+    // blocks), delivering everything due before each one
+    template<typename Strategy>
+    void run(const OrderEvent* events, size_t n, Strategy& strategy) {
+        for (size_t i = 0; i < n; ++i) {
+            const OrderEvent& ev = events[i];
+            deliver_before(ev.timestamp_ns, strategy);
+            book_event(ev);
+            market.push(Delivery{market.stamp(ev.timestamp_ns, latency.market_data, rng), ev});
+        }
+    }
+
+    // deliver everything still in flight (end of session)
+    template<typename Strategy>
+    void finish(Strategy& strategy) {
+        deliver_before(UINT64_MAX, strategy);
+    }
+
+    // the venue's book on the venue clock, without latency
+    const Book& book() const { return venue; }
+
+    bool resting(uint64_t id) const { return orders[id - 1].state == OrderState::Resting; }
+    uint64_t leaves(uint64_t id) const { return orders[id - 1].leaves; }
+    uint64_t queue_ahead(uint64_t id) const { return orders[id - 1].ahead; }
+    const SimStats& stats() const { return counts; }
+
+private:
+    enum class OrderState : uint8_t { InFlight, Resting, Done };
+
+    struct SimOrder {
+        double price;
+        uint64_t quantity;
+        uint64_t leaves;
+        uint64_t ahead;         // historical quantity queued in front of us
+        uint64_t arrival_ns;    // venue time it joined the queue
+        bool is_buy;
+        OrderState state;
+    };
+
+    struct Request {
+        uint64_t at_ns;
+        uint64_t order_id;
+        bool cancel;
+    };
+
+    struct Delivery {
+        uint64_t at_ns;
+        OrderEvent event;
+    };
+
+    // part of a historical level our aggressive orders already filled against
+    struct Taken {
+        double price;
+        uint64_t shown;         // the level's historical quantity at the time
+        uint64_t quantity;      // taken out of it
+        bool is_buy;            // side of the level
+    };
+
+    // one message path: a ring that keeps its storage, with arrival times
+    // clamped so messages stay in send order
+    template<typename T>
+    struct Channel {
+        std::vector<T> ring = std::vector<T>(64);
+        size_t head = 0;
+        size_t count = 0;
+        uint64_t last_ns = 0;
+
+        uint64_t stamp(uint64_t sent_ns, const LatencyModel& m, std::mt19937_64& r) {
+            last_ns = std::max(last_ns, sent_ns + m.sample(r));
+            return last_ns;
+        }
+
+        bool empty() const { return count == 0; }
+        uint64_t next_ns() const { return count ? time_of(ring[head]) : UINT64_MAX; }
+
+        void push(const T& v) {
+            if (OB_UNLIKELY(count == ring.size())) {
+                std::rotate(ring.begin(), ring.begin() + head, ring.end());
+                head = 0;
+                ring.resize(ring.size() * 2);
+            }
+            ring[(head + count) & (ring.size() - 1)] = v;
+            ++count;
+        }
+
+        T pop() {
+            T v = ring[head];
+            head = (head + 1) & (ring.size() - 1);
+            --count;
+            return v;
+        }
+
+        static uint64_t time_of(const Request& r) { return r.at_ns; }
+        static uint64_t time_of(const Delivery& d) { return d.at_ns; }
+        static uint64_t time_of(const SimReport& r) { return r.local_ns; }
+    };
+
+    static bool same_level(double a, double b) {
+        return Book::Price::to_key(a) == Book::Price::to_key(b);
+    }
+
+    // does a buy (sell) limit at ours trade with the other side at price
+    static bool crosses(bool ours_buy, double ours, double price) {
+        return ours_buy ? price <= ours : price >= ours;
+    }
+
+    // strictly better for its side than price
+    static bool better(bool is_buy, double ours, double price) {
+        return !same_level(ours, price) && (is_buy ? ours > price : ours < price);
+    }
+
+    // hand out what is due before venue time t, in time order: requests
+    // reach the venue first, then market data, then reports
+    template<typename Strategy>
+    void deliver_before(uint64_t t, Strategy& strategy) {
+        for (;;) {
+            uint64_t ta = requests.next_ns(), tm = market.next_ns(), tr = reports.next_ns();
+            uint64_t first = std::min(ta, std::min(tm, tr));
+            if (OB_LIKELY(first >= t)) return;
+            if (ta == first) {
+                venue_request(requests.pop());
+            } else if (tm == first) {
+                Delivery d = market.pop();
+                strategy.on_market(d.event, d.at_ns);
+            } else {
+                strategy.on_report(reports.pop());
+            }
+        }
+    }
+
+    void report(SimReportKind kind, uint64_t id, double price, uint64_t quantity, uint64_t t) {
+        const SimOrder& o = orders[id - 1];
+        reports.push(SimReport{kind, o.is_buy, id, price, quantity, o.leaves, t,
+                               reports.stamp(t, latency.reports, rng)});
+    }
+
+    void fill(uint64_t id, uint64_t quantity, double price, uint64_t t) {
+        SimOrder& o = orders[id - 1];
+        o.leaves -= quantity;
+        if (o.leaves == 0) o.state = OrderState::Done;
+        ++counts.fills;
+        counts.filled_quantity += quantity;
+        report(SimReportKind::Fill, id, price, quantity, t);
+    }
+
+    // an order or cancel of ours reaches the venue
+    void venue_request(const Request& r) {
+        SimOrder& o = orders[r.order_id - 1];
+        if (r.cancel) {
+            if (o.state == OrderState::Resting) {
+                o.state = OrderState::Done;
+                uint64_t left = o.leaves;
+                o.leaves = 0;
+                ++counts.canceled;
+                report(SimReportKind::Canceled, r.order_id, o.price, left, r.at_ns);
+                drop_done();
+            } else {
+                ++counts.rejected;
+                report(SimReportKind::Rejected, r.order_id, o.price, 0, r.at_ns);
+            }
+            return;
+        }
+
+        o.state = OrderState::Resting;
+        report(SimReportKind::Ack, r.order_id, o.price, 0, r.at_ns);
+
+        // take what the opposite side shows up to the limit, less what we
+        // already took from it
+        venue.walk_levels(!o.is_buy, [&](double price, uint64_t quantity) {
+            if (!crosses(o.is_buy, o.price, price)) return false;
+            Taken& t = taken_at(!o.is_buy, price, quantity);
+            uint64_t q = std::min(o.leaves, quantity - t.quantity);
+            if (q) {
+                t.quantity += q;
+                fill(r.order_id, q, price, r.at_ns);
+                // it came off the front of the queue, ahead of our own orders there
+                for (uint64_t id : live) {
+                    SimOrder& mine = orders[id - 1];
+                    if (mine.is_buy != o.is_buy && same_level(mine.price, price)) {
+                        mine.ahead -= std::min(mine.ahead, q);
+                    }
+                }
+            }
+            return o.leaves != 0;
+        });
+        if (o.state == OrderState::Resting) {
+            uint64_t shown = venue.level_quantity(o.is_buy, o.price);
+            o.ahead = shown - taken_from(o.is_buy, o.price, shown);
+            o.arrival_ns = r.at_ns;
+            live.push_back(r.order_id);
+        }
+    }
+
+    // a historical event at the venue: move our queue positions, then the book
+    void book_event(const OrderEvent& ev) {
+        venue.expire_orders(ev.timestamp_ns);
+        if (OB_UNLIKELY(!live.empty())) {
+            track(ev);
+        }
+        venue.apply(ev);
+        if (OB_UNLIKELY(!taken.empty())) {
+            forget_taken();
+        }
+    }
+
+    // record for the level (is_buy, price) showing shown; a fresh one if none
+    Taken& taken_at(bool is_buy, double price, uint64_t shown) {
+        for (Taken& t : taken) {
+            if (t.is_buy == is_buy && same_level(t.price, price)) return t;
+        }
+        taken.push_back(Taken{price, shown, 0, is_buy});
+        return taken.back();
+    }
+
+    uint64_t taken_from(bool is_buy, double price, uint64_t shown) const {
+        for (const Taken& t : taken) {
+            if (t.is_buy == is_buy && same_level(t.price, price)) return std::min(t.quantity, shown);
+        }
+        return 0;
+    }
+
+    // a level whose historical quantity moved is fresh liquidity again
+    void forget_taken() {
+        taken.erase(std::remove_if(taken.begin(), taken.end(),
+                                   [&](const Taken& t) {
+                                       return venue.level_quantity(t.is_buy, t.price) != t.shown;
+                                   }),
+                    taken.end());
+    }
+
+    void track(const OrderEvent& ev) {
+        const uint64_t t = ev.timestamp_ns;
+        if (ev.type == EventType::Add) {
+            cross_us(ev.is_buy, ev.price, ev.quantity, t);
+            return;
+        }
+        const Order* h = venue.find_order(ev.order_id);
+        if (!h) return;
+
+        switch (ev.type) {
+        case EventType::Cancel:
+            leave_level(*h, h->quantity);
+            break;
+        case EventType::Amend:
+            if (same_level(h->price, ev.price)) {
+                if (ev.quantity < h->quantity) {
+                    leave_level(*h, h->quantity - ev.quantity);
+                } else {
+                    for_level(*h, [&](SimOrder& o) { o.ahead += ev.quantity - h->quantity; });
+                }
+            } else if (ev.quantity != 0) {     // the book rejects a reprice to 0
+                leave_level(*h, h->quantity);
+                cross_us(h->is_buy, ev.price, ev.quantity, t);
+            }
+            break;
+        case EventType::Execute:
+            trade(*h, std::min(ev.quantity, h->quantity), t);
+            break;
+        default:
+            break;
+        }
+        drop_done();
+    }
+
+    // f(order) for our resting orders at h's level that h is ahead of
+    template<typename F>
+    void for_level(const Order& h, F&& f) {
+        for (uint64_t id : live) {
+            SimOrder& o = orders[id - 1];
+            if (o.is_buy == h.is_buy && same_level(o.price, h.price) && h.timestamp_ns <= o.arrival_ns) f(o);
+        }
+    }
+
+    void leave_level(const Order& h, uint64_t quantity) {
+        for_level(h, [&](SimOrder& o) { o.ahead -= std::min(o.ahead, quantity); });
+    }
+
+    // quantity arriving on side is_buy at price: trades with our opposite
+    // orders it crosses, at our price, oldest first
+    void cross_us(bool is_buy, double price, uint64_t quantity, uint64_t t) {
+        for (uint64_t id : live) {
+            SimOrder& o = orders[id - 1];
+            if (quantity == 0) break;
+            if (o.is_buy == is_buy || o.state != OrderState::Resting || !crosses(o.is_buy, o.price, price)) continue;
+            uint64_t q = std::min(o.leaves, quantity);
+            quantity -= q;
+            fill(id, q, o.price, t);
+        }
+    }
+
+    // quantity traded against resting order h
+    void trade(const Order& h, uint64_t quantity, uint64_t t) {
+        for (uint64_t id : live) {
+            SimOrder& o = orders[id - 1];
+            if (o.is_buy != h.is_buy || o.state != OrderState::Resting) continue;
+            if (same_level(o.price, h.price)) {
+                if (h.timestamp_ns <= o.arrival_ns) {
+                    o.ahead -= std::min(o.ahead, quantity);     // the queue ahead traded
+                    continue;
+                }
+                o.ahead = 0;    // the trade reached behind us
+            } else if (!better(o.is_buy, o.price, h.price)) {
+                continue;
+            }
+            uint64_t q = std::min(o.leaves, quantity);
+            if (q == 0) break;
+            quantity -= q;
+            fill(id, q, o.price, t);
+        }
+    }
+
+    void drop_done() {
+        live.erase(std::remove_if(live.begin(), live.end(),
+                                  [&](uint64_t id) { return orders[id - 1].state != OrderState::Resting; }),
+                   live.end());
+    }
+
+    SimLatency latency;
+    std::mt19937_64 rng;
+    Book venue;
+
+    std::vector<SimOrder> orders;   // by id - 1
+    std::vector<uint64_t> live;     // resting ids, oldest first
+    std::vector<Taken> taken;       // by level, dropped once the level changes
+    SimStats counts;
+
+    Channel<Request> requests;
+    Channel<Delivery> market;
+    Channel<SimReport> reports;
+};
+
+using SimExchange = BasicSimExchange<DefaultConfig>;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "orderbook/compiler.h"
+
+// Vector of trivially copyable T with room for N elements inline; spills to
+// the heap (doubling) only when it outgrows them. Meant for the many tiny
+// per-series level lists of a thin book, where a std::vector's separate
+// allocation would cost more than the data.
+template<typename T, size_t N>
+class SmallVector {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved with memcpy");
+    static_assert(N > 0, "inline capacity must be at least one element");
+
+    T* ptr;
+    uint32_t count = 0;
+    uint32_t cap = N;
+    alignas(T) unsigned char inline_buf[N * sizeof(T)];
+
+    bool on_heap() const { return ptr != reinterpret_cast<const T*>(inline_buf); }
+
+    OB_COLD void grow() {
+        uint32_t new_cap = cap * 2;
+        T* bigger = static_cast<T*>(std::malloc(new_cap * sizeof(T)));
+        if (!bigger) throw std::bad_alloc();
+        std::memcpy(static_cast<void*>(bigger), ptr, count * sizeof(T));
+        if (on_heap()) std::free(ptr);
+        ptr = bigger;
+        cap = new_cap;
+    }
+
+    void steal(SmallVector& other) {
+        count = other.count;
+        cap = other.cap;
+        if (other.on_heap()) {
+            ptr = other.ptr;
+        } else {
+            ptr = reinterpret_cast<T*>(inline_buf);
+            std::memcpy(static_cast<void*>(ptr), other.ptr, count * sizeof(T));
+        }
+        other.ptr = reinterpret_cast<T*>(other.inline_buf);
+        other.count = 0;
+        other.cap = N;
+    }
+
+public:
+    SmallVector() : ptr(reinterpret_cast<T*>(inline_buf)) {}
+
+    ~SmallVector() {
+        if (on_heap()) std::free(ptr);
+    }
+
+    SmallVector(SmallVector&& other) noexcept { steal(other); }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            if (on_heap()) std::free(ptr);
+            steal(other);
+        }
+        return *this;
+    }
+
+    SmallVector(const SmallVector&) = delete;
+    SmallVector& operator=(const SmallVector&) = delete;
+
+    T* begin() { return ptr; }
+    T* end() { return ptr + count; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return cap; }
+
+    // bytes allocated outside the object (0 while inline)
+    size_t heap_bytes() const { return on_heap() ? cap * sizeof(T) : 0; }
+
+    T* insert(T* pos, const T& value) {
+        size_t i = static_cast<size_t>(pos - ptr);
+        if (OB_UNLIKELY(count == cap)) grow();
+        std::memmove(static_cast<void*>(ptr + i + 1), ptr + i, (count - i) * sizeof(T));
+        ptr[i] = value;
+        ++count;
+        return ptr + i;
+    }
+
+    void erase(T* pos) {
+        size_t i = static_cast<size_t>(pos - ptr);
+        std::memmove(static_cast<void*>(ptr + i), ptr + i + 1, (count - i - 1) * sizeof(T));
+        --count;
+    }
+
+    void clear() { count = 0; }
+};
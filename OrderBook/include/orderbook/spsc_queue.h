@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Single-producer single-consumer ring, after Fifo3 in SPSC_QUEUES/spsc_q3.cpp:
+// monotonically increasing push/pop cursors on separate cache lines, acquire
+// on the other side's cursor, release on our own. Capacity is rounded up to
+// a power of two so the slot index is a mask. T must be trivially copyable;
+// slots are plain storage.
+template<typename T>
+class SpscQueue {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "slots are copied as plain storage");
+
+    static constexpr size_t kCacheLine = 64;
+
+    static size_t round_up(size_t n) {
+        size_t cap = 2;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    std::vector<T> ring;
+    size_t mask;
+
+    // loaded and stored by the push thread; loaded by the pop thread
+    alignas(kCacheLine) std::atomic<size_t> push_cursor{0};
+
+    // loaded and stored by the pop thread; loaded by the push thread
+    alignas(kCacheLine) std::atomic<size_t> pop_cursor{0};
+
+    // padding to avoid false sharing with adjacent objects
+    char padding[kCacheLine - sizeof(size_t)];
+
+public:
+    explicit SpscQueue(size_t capacity) : ring(round_up(capacity)), mask(ring.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // false if the queue is full
+    bool push(const T& value) {
+        size_t push_at = push_cursor.load(std::memory_order_relaxed);
+        if (push_at - pop_cursor.load(std::memory_order_acquire) == ring.size()) {
+            return false;
+        }
+        ring[push_at & mask] = value;
+        push_cursor.store(push_at + 1, std::memory_order_release);
+        return true;
+    }
+
+    // false if the queue is empty
+    bool pop(T& value) {
+        size_t pop_at = pop_cursor.load(std::memory_order_relaxed);
+        if (pop_at == push_cursor.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = ring[pop_at & mask];
+        pop_cursor.store(pop_at + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return push_cursor.load(std::memory_order_relaxed) - pop_cursor.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return ring.size(); }
+};
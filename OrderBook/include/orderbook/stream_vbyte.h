@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// per control byte: data length and the pshufb mask expanding it to 4 x uint32
+struct StreamVByteTables {
+    uint8_t length[256];
+    uint8_t shuffle[256][16];
+
+    constexpr StreamVByteTables() : length(), shuffle() {
+        for (unsigned c = 0; c < 256; ++c) {
+            unsigned offset = 0;
+            for (unsigned k = 0; k < 4; ++k) {
+                unsigned len = ((c >> (2 * k)) & 3) + 1;
+                for (unsigned b = 0; b < 4; ++b) {
+                    shuffle[c][4 * k + b] = b < len ? uint8_t(offset + b) : uint8_t(0xff);
+                }
+                offset += len;
+            }
+            length[c] = uint8_t(offset);
+        }
+    }
+};
+
+inline constexpr StreamVByteTables kStreamVByteTables{};
+
+// Stream VByte integer codec for the 32-bit columns of compressed event
+// files (quantities, price tick deltas, time deltas, id deltas). Each value
+// takes 1-4 bytes; its length lives in a separate control stream, two bits
+// per value and four values per control byte:
+//
+//   [control: (n + 3) / 4 bytes][data: 1-4 bytes per value]
+//
+// With lengths out of the data, a decoder expands four values with one
+// table lookup and one pshufb (SSSE3), or eight with AVX2, instead of
+// testing a continuation bit per byte as LEB128 varints do. Kernels are
+// picked at compile time like order_columns.h: build with ORDERBOOK_NATIVE
+// (the release preset) to get them, otherwise the scalar fallback runs.
+//
+// Encoding is scalar and branchless (one 4-byte store per value); decoding
+// is the hot side. The *_delta variants store zigzag(x[i] - x[i-1]) so
+// slowly moving or unsorted sequences (ids, timestamps, prices) stay short,
+// and undo it with a vector prefix sum.
+class StreamVByte {
+private:
+    static constexpr const StreamVByteTables& kTables = kStreamVByteTables;
+
+    // 2-bit length code: 0 for 1 byte ... 3 for 4 bytes (highest set byte)
+    static inline uint32_t code_of(uint32_t v) {
+        return uint32_t(31 - __builtin_clz(v | 1)) >> 3;
+    }
+
+    static inline uint32_t zigzag32(int32_t v) { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+    static inline int32_t unzigzag32(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+    // one value of length code c at p; reads exactly code + 1 bytes
+    static inline uint32_t load_value(const uint8_t* p, uint32_t c) {
+        uint32_t v = p[0];
+        if (c > 0) v |= uint32_t(p[1]) << 8;
+        if (c > 1) v |= uint32_t(p[2]) << 16;
+        if (c > 2) v |= uint32_t(p[3]) << 24;
+        return v;
+    }
+
+    template<bool Delta>
+    static size_t encode_impl(const uint32_t* in, size_t n, uint8_t* out, uint32_t prev) {
+        uint8_t* control = out;
+        uint8_t* data = out + (n + 3) / 4;
+        std::memset(control, 0, (n + 3) / 4);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t v = in[i];
+            if (Delta) {
+                uint32_t d = zigzag32(int32_t(v - prev));
+                prev = v;
+                v = d;
+            }
+            uint32_t c = code_of(v);
+            control[i >> 2] |= uint8_t(c << (2 * (i & 3)));
+            std::memcpy(data, &v, 4);       // little-endian; the slack covers the overhang
+            data += c + 1;
+        }
+        return size_t(data - out);
+    }
+
+    // scalar tail / fallback from value i on; returns the data pointer after it
+    template<bool Delta>
+    static const uint8_t* decode_scalar_from(const uint8_t* control, const uint8_t* data, size_t i, size_t n,
+                                             uint32_t* out, uint32_t prev) {
+        for (; i < n; ++i) {
+            uint32_t c = (control[i >> 2] >> (2 * (i & 3))) & 3;
+            uint32_t v = load_value(data, c);
+            data += c + 1;
+            if (Delta) {
+                prev += uint32_t(unzigzag32(v));
+                v = prev;
+            }
+            out[i] = v;
+        }
+        return data;
+    }
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    // four decoded zigzag deltas -> running values, continuing from prev
+    static inline __m128i prefix_sum(__m128i d, __m128i& prev) {
+        const __m128i one = _mm_set1_epi32(1);
+        d = _mm_xor_si128(_mm_srli_epi32(d, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(d, one)));
+        d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+        d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+        d = _mm_add_epi32(d, prev);
+        prev = _mm_shuffle_epi32(d, 0xff);
+        return d;
+    }
+#endif
+
+    template<bool Delta>
+    static size_t decode_impl(const uint8_t* in, size_t in_bytes, size_t n, uint32_t* out, uint32_t prev) {
+        const uint8_t* control = in;
+        const uint8_t* data = in + (n + 3) / 4;
+        const uint8_t* end = in + in_bytes;
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        // eight values per step: two control bytes, two 16-byte loads
+        __m128i running = _mm_set1_epi32(int32_t(prev));
+        for (; i + 8 <= n; i += 8) {
+            uint8_t c0 = control[i >> 2];
+            uint8_t c1 = control[(i >> 2) + 1];
+            const uint8_t* p1 = data + kTables.length[c0];
+            if (p1 + 16 > end) break;
+
+            __m256i bytes = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1)), 1);
+            __m256i mask = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kTables.shuffle[c0]))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(kTables.shuffle[c1])), 1);
+            __m256i v = _mm256_shuffle_epi8(bytes, mask);
+
+            if (Delta) {
+                __m128i lo = prefix_sum(_mm256_castsi256_si128(v), running);
+                __m128i hi = prefix_sum(_mm256_extracti128_si256(v, 1), running);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), hi);
+            } else {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+            }
+            data = p1 + kTables.length[c1];
+        }
+        if (Delta && i) prev = uint32_t(_mm_cvtsi128_si32(running));
+#elif defined(__SSSE3__)
+        __m128i running = _mm_set1_epi32(int32_t(prev));
+        for (; i + 4 <= n; i += 4) {
+            if (data + 16 > end) break;
+            uint8_t c = control[i >> 2];
+            __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(kTables.shuffle[c])));
+            if (Delta) v = prefix_sum(v, running);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+            data += kTables.length[c];
+        }
+        if (Delta && i) prev = uint32_t(_mm_cvtsi128_si32(running));
+#else
+        (void)end;
+#endif
+
+        data = decode_scalar_from<Delta>(control, data, i, n, out, prev);
+        return size_t(data - in);
+    }
+
+public:
+    // output buffer size for n values (includes 3 bytes of store slack)
+    static constexpr size_t max_encoded_bytes(size_t n) {
+        return (n + 3) / 4 + 4 * n + 3;
+    }
+
+    // true when the decode kernels are vectorized in this build
+    static constexpr bool kVectorized =
+#if defined(__SSSE3__) || defined(__AVX2__)
+        true;
+#else
+        false;
+#endif
+
+    // encode n values into out (max_encoded_bytes(n) bytes); returns bytes used
+    static size_t encode(const uint32_t* in, size_t n, uint8_t* out) {
+        return encode_impl<false>(in, n, out, 0);
+    }
+
+    // decode n values from the in_bytes-long buffer at in; returns bytes consumed
+    static size_t decode(const uint8_t* in, size_t in_bytes, size_t n, uint32_t* out) {
+        return decode_impl<false>(in, in_bytes, n, out, 0);
+    }
+
+    // delta + zigzag variants; prev is the value before in[0] (wraps mod 2^32)
+    static size_t encode_delta(const uint32_t* in, size_t n, uint8_t* out, uint32_t prev = 0) {
+        return encode_impl<true>(in, n, out, prev);
+    }
+
+    static size_t decode_delta(const uint8_t* in, size_t in_bytes, size_t n, uint32_t* out, uint32_t prev = 0) {
+        return decode_impl<true>(in, in_bytes, n, out, prev);
+    }
+
+    // reference decoders regardless of build flags (tests, benchmarks)
+    static size_t decode_scalar(const uint8_t* in, size_t n, uint32_t* out) {
+        return size_t(decode_scalar_from<false>(in, in + (n + 3) / 4, 0, n, out, 0) - in);
+    }
+
+    static size_t decode_delta_scalar(const uint8_t* in, size_t n, uint32_t* out, uint32_t prev = 0) {
+        return size_t(decode_scalar_from<true>(in, in + (n + 3) / 4, 0, n, out, prev) - in);
+    }
+};
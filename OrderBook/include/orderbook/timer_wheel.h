@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel for order expiry (GTT / day orders).
+//
+// Timers are keyed by a 32-bit handle (the order's pool handle) and linked
+// intrusively, so schedule and cancel are O(1) and need no allocation once
+// the node table covers the handle range. Slots are 1024 ns ticks; six levels
+// of 64 slots cover 2^36 ticks (~19.5 hours) and anything further out parks
+// in the top level and is re-cascaded each rotation. Firing still compares the
+// exact expiry: timers in the tick that now_ns falls inside wait on a held
+// list until their nanosecond comes, so nothing fires early or late.
+//
+// advance(now) jumps straight between occupied slots using per-level
+// occupancy bitmaps, so idle periods and session-end sweeps cost time
+// proportional to the timers that are due, never to the size of the book.
+class TimerWheel {
+public:
+    using Handle = uint32_t;
+
+    static constexpr unsigned kTickShift = 10;
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr unsigned kSlots = 1u << kSlotBits;
+    static constexpr unsigned kLevels = 6;
+    static constexpr uint64_t kMaxTicks = uint64_t(1) << (kSlotBits * kLevels);
+
+private:
+    static constexpr Handle kNull = UINT32_MAX;
+    static constexpr uint16_t kUnscheduled = UINT16_MAX;
+    // extra lists: entries detached from a slot while it is processed, and
+    // entries of the current tick that are not yet due to the nanosecond
+    static constexpr uint16_t kPendingList = kLevels * kSlots;
+    static constexpr uint16_t kHeldList = kPendingList + 1;
+
+    struct Node {
+        uint64_t expiry = 0;    // exact expiry in ns
+        Handle prev = kNull;
+        Handle next = kNull;
+        uint16_t list = kUnscheduled;
+    };
+
+    std::vector<Node> nodes;
+    Handle heads[kLevels * kSlots + 2];
+    uint64_t occupied[kLevels] = {};
+    uint64_t current = 0;       // ticks whose timers are fired or held
+    uint64_t clock = 0;         // latest now_ns seen
+    size_t count = 0;
+
+    static inline uint64_t to_tick_ceil(uint64_t ns) {
+        return (ns >> kTickShift) + ((ns & ((uint64_t(1) << kTickShift) - 1)) != 0);
+    }
+
+    static inline unsigned level_for(uint64_t now, uint64_t when) {
+        uint64_t masked = (now ^ when) | (kSlots - 1);
+        if (masked >= kMaxTicks) masked = kMaxTicks - 1;
+        unsigned significant = 63 - unsigned(__builtin_clzll(masked));
+        return significant / kSlotBits;
+    }
+
+    inline void link(Handle h, uint16_t list) {
+        Node& n = nodes[h];
+        n.list = list;
+        n.prev = kNull;
+        n.next = heads[list];
+        if (n.next != kNull) nodes[n.next].prev = h;
+        heads[list] = h;
+        if (list < kPendingList) occupied[list / kSlots] |= uint64_t(1) << (list % kSlots);
+    }
+
+    inline void unlink(Handle h) {
+        Node& n = nodes[h];
+        if (n.prev != kNull) {
+            nodes[n.prev].next = n.next;
+        } else {
+            heads[n.list] = n.next;
+            if (n.next == kNull && n.list < kPendingList) {
+                occupied[n.list / kSlots] &= ~(uint64_t(1) << (n.list % kSlots));
+            }
+        }
+        if (n.next != kNull) nodes[n.next].prev = n.prev;
+        n.list = kUnscheduled;
+    }
+
+    inline void place(Handle h) {
+        uint64_t when = to_tick_ceil(nodes[h].expiry);
+        if (when <= current) {
+            link(h, kHeldList);
+            return;
+        }
+        unsigned level = level_for(current, when);
+        unsigned slot = unsigned(when >> (level * kSlotBits)) & (kSlots - 1);
+        link(h, uint16_t(level * kSlots + slot));
+    }
+
+    // fire every pending entry due by clock; the rest go back to a slot or
+    // the held list
+    template<typename F>
+    size_t drain_pending(F& on_expire) {
+        size_t fired = 0;
+        while (heads[kPendingList] != kNull) {
+            Handle h = heads[kPendingList];
+            unlink(h);
+            if (nodes[h].expiry <= clock) {
+                --count;
+                ++fired;
+                on_expire(h);
+            } else {
+                place(h);   // cascade to a finer level, or hold
+            }
+        }
+        return fired;
+    }
+
+    inline void detach(uint16_t list) {
+        while (heads[list] != kNull) {
+            Handle h = heads[list];
+            unlink(h);
+            link(h, kPendingList);
+        }
+    }
+
+    // earliest occupied slot across levels; lower levels always expire first
+    bool next_expiration(unsigned& list, uint64_t& deadline) const {
+        for (unsigned level = 0; level < kLevels; ++level) {
+            if (!occupied[level]) continue;
+
+            // the top level's current slot only holds timers parked for a
+            // later rotation, so its search starts one slot ahead
+            unsigned shift = level * kSlotBits;
+            unsigned now_slot = unsigned(current >> shift) & (kSlots - 1);
+            unsigned start = (now_slot + (level == kLevels - 1)) & (kSlots - 1);
+            uint64_t rotated = (occupied[level] >> start) |
+                               (start ? occupied[level] << (kSlots - start) : 0);
+            unsigned slot = (start + unsigned(__builtin_ctzll(rotated))) & (kSlots - 1);
+
+            uint64_t slot_range = uint64_t(1) << shift;
+            uint64_t level_range = slot_range << kSlotBits;
+            deadline = (current & ~(level_range - 1)) + slot * slot_range;
+            // only the top level wraps: a slot behind us is the next rotation
+            if (deadline <= current && level == kLevels - 1) deadline += level_range;
+            if (deadline < current) deadline = current;
+
+            list = level * kSlots + slot;
+            return true;
+        }
+        return false;
+    }
+
+public:
+    TimerWheel() {
+        for (Handle& h : heads) h = kNull;
+    }
+
+    // size the node table for handles [0, n) so schedule() never allocates
+    void reserve(size_t n) {
+        if (n > nodes.size()) nodes.resize(n);
+    }
+
+    // arm (or re-arm) a timer. now_hint_ns lets an empty wheel skip forward
+    // to the caller's clock; returns false if expiry_ns is not after both the
+    // wheel's clock and now_hint_ns, whether or not other timers are armed
+    bool schedule(Handle h, uint64_t expiry_ns, uint64_t now_hint_ns = 0) {
+        if (h >= nodes.size()) nodes.resize(size_t(h) + 1 + nodes.size() / 2);
+        if (nodes[h].list != kUnscheduled) cancel(h);
+
+        if (count == 0 && now_hint_ns > clock) {
+            clock = now_hint_ns;
+            if (to_tick_ceil(clock) > current) current = to_tick_ceil(clock);
+        }
+        if (expiry_ns <= clock || expiry_ns <= now_hint_ns) return false;
+
+        nodes[h].expiry = expiry_ns;
+        place(h);
+        ++count;
+        return true;
+    }
+
+    // disarm; no-op if h is not scheduled
+    void cancel(Handle h) {
+        if (h >= nodes.size() || nodes[h].list == kUnscheduled) return;
+        unlink(h);
+        --count;
+    }
+
+    bool scheduled(Handle h) const {
+        return h < nodes.size() && nodes[h].list != kUnscheduled;
+    }
+
+    // fire on_expire(h) for every timer with expiry <= now_ns; the callback
+    // may cancel or schedule other timers. Returns the number fired
+    template<typename F>
+    size_t advance(uint64_t now_ns, F&& on_expire) {
+        if (now_ns <= clock) return 0;
+        clock = now_ns;
+
+        // the tick now_ns falls in counts as reached; its timers that are
+        // still ahead of now_ns stay held
+        uint64_t target = to_tick_ceil(now_ns);
+        size_t fired = 0;
+        unsigned list;
+        uint64_t deadline;
+
+        if (heads[kHeldList] != kNull) {
+            detach(kHeldList);
+            fired += drain_pending(on_expire);
+        }
+
+        while (count && next_expiration(list, deadline) && deadline <= target) {
+            current = deadline;
+            // detach the slot so re-placed entries cannot land back in it
+            detach(uint16_t(list));
+            fired += drain_pending(on_expire);
+        }
+
+        if (target > current) current = target;
+        return fired;
+    }
+
+    size_t size() const { return count; }
+    uint64_t now_ns() const { return clock; }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// LEB128-style variable-length integers: 7 bits per byte, high bit set on
+// every byte but the last. Signed deltas go through zigzag first so small
+// negative values stay short (0, -1, 1, -2 ... -> 0, 1, 2, 3 ...).
+
+inline uint64_t zigzag_encode(int64_t v) {
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t v) {
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(uint8_t(v));
+}
+
+// decode one varint at p and advance p; at most 10 bytes are read
+inline uint64_t get_varint(const uint8_t*& p) {
+    uint64_t v = *p & 0x7f;
+    if (!(*p++ & 0x80)) return v;
+    for (unsigned shift = 7; shift < 64; shift += 7) {
+        uint64_t b = *p++;
+        v |= (b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return v;
+}
@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+# Profile-guided build driven by a replay file.
+#
+#   scripts/pgo.sh [day.rpl]
+#
+# 1. builds the `lto` preset as the baseline
+# 2. builds the instrumented `pgo-generate` preset
+# 3. trains it by replaying the recorded day (a synthetic day is generated
+#    if no file is given) through both `replay` and `orderbook_bench --train`
+# 4. rebuilds the same tree as `pgo-use` with the collected profile
+# 5. benchmarks baseline and PGO builds and prints the per-benchmark delta
+#
+# GCC names .gcda files after the object file path, so generate and use
+# share one build directory (build/pgo).
+set -euo pipefail
+
+cd "$(dirname "$0")/.."
+day="${1:-build/pgo-train.rpl}"
+profile_dir=build/pgo-profile
+
+cmake --preset lto
+cmake --build --preset lto -j"$(nproc)"
+
+if [[ ! -f "$day" ]]; then
+    echo "== generating synthetic training day: $day"
+    ./build/lto/replay --generate "$day" 2000000
+fi
+
+echo "== instrumented build"
+rm -rf "$profile_dir"
+cmake --preset pgo-generate
+cmake --build --preset pgo-generate -j"$(nproc)"
+
+echo "== training on $day"
+./build/pgo/replay "$day"
+./build/pgo/orderbook_bench --replay "$day" --train --passes 1
+
+echo "== optimized build"
+cmake --preset pgo-use
+cmake --build --preset pgo-use -j"$(nproc)"
+
+echo "== baseline benchmark"
+./build/lto/orderbook_bench --replay "$day" --save build/bench-lto.txt > /dev/null
+echo "== PGO benchmark"
+./build/pgo/orderbook_bench --replay "$day" --compare build/bench-lto.txt
@@ -1,45 +1,27 @@
 // AI generated
 
-#include "main.cpp"
-#include <chrono>
+#include "orderbook/order_book.h"
+#include "orderbook/bar_consumer.h"
+#include "orderbook/book_diff.h"
+#include "orderbook/columnar_file.h"
+#include "orderbook/consolidated_book.h"
+#include "orderbook/event_merge.h"
+#include "orderbook/implied_book.h"
+#include "orderbook/instrument.h"
+#include "orderbook/options_chain.h"
+#include "orderbook/pool_handoff.h"
+#include "orderbook/sim_exchange.h"
+#include "orderbook/stream_vbyte.h"
+#include "orderbook/order_router.h"
+#include <map>
+#include <memory>
+#include <numeric>
 #include <random>
 #include <cassert>
-#include <numeric>
+#include <cstring>
 
 using namespace std;
 
-// ============================================================================
-// Timing Utilities
-// ============================================================================
-
-class Timer {
-private:
-    chrono::high_resolution_clock::time_point start_time;
-
-public:
-    Timer() : start_time(chrono::high_resolution_clock::now()) {}
-
-    void reset() {
-        start_time = chrono::high_resolution_clock::now();
-    }
-
-    // Returns elapsed time in nanoseconds
-    int64_t elapsed_ns() const {
-        auto end_time = chrono::high_resolution_clock::now();
-        return chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count();
-    }
-
-    // Returns elapsed time in microseconds
-    double elapsed_us() const {
-        return elapsed_ns() / 1000.0;
-    }
-
-    // Returns elapsed time in milliseconds
-    double elapsed_ms() const {
-        return elapsed_ns() / 1000000.0;
-    }
-};
-
 // ============================================================================
 // Test Framework
 // ============================================================================
@@ -250,210 +232,1600 @@ TEST(test_fifo_ordering) {
     ASSERT(bids[0].total_quantity == 30, "Remaining quantity should be 30");
 }
 
-// ============================================================================
-// Performance Benchmarks
-// ============================================================================
+TEST(test_metrics_counters) {
+    OrderBook book;
 
-struct BenchmarkResult {
-    string name;
-    double avg_ns;
-    double median_ns;
-    double min_ns;
-    double max_ns;
-    double p95_ns;
-    double p99_ns;
-
-    void print() const {
-        cout << "\n  " << name << ":\n";
-        cout << "    Avg:    " << fixed << setprecision(2) << avg_ns << " ns (" << avg_ns / 1000.0 << " us)\n";
-        cout << "    Median: " << median_ns << " ns (" << median_ns / 1000.0 << " us)\n";
-        cout << "    Min:    " << min_ns << " ns (" << min_ns / 1000.0 << " us)\n";
-        cout << "    Max:    " << max_ns << " ns (" << max_ns / 1000.0 << " us)\n";
-        cout << "    P95:    " << p95_ns << " ns (" << p95_ns / 1000.0 << " us)\n";
-        cout << "    P99:    " << p99_ns << " ns (" << p99_ns / 1000.0 << " us)\n";
-    }
-};
+    book.add_order(Order(1, true, 100.0, 10, 1000));
+    book.add_order(Order(2, false, 101.0, 20, 2000));
+    book.amend_order(1, 100.0, 15);
+    book.cancel_order(2);
+    book.cancel_order(999);  // reject
+
+    const BookCounters& c = book.get_counters();
+    ASSERT(c.messages.load() == 5, "Should count 5 messages");
+    ASSERT(c.orders_added.load() == 2, "Should count 2 adds");
+    ASSERT(c.orders_amended.load() == 1, "Should count 1 amend");
+    ASSERT(c.orders_canceled.load() == 1, "Should count 1 cancel");
+    ASSERT(c.rejects.load() == 1, "Should count 1 reject");
+    ASSERT(c.resting_orders.load() == 1, "Gauge should show 1 resting order");
+    ASSERT(c.bid_levels.load() == 1 && c.ask_levels.load() == 0, "Level gauges should match book");
+}
 
-BenchmarkResult calculate_stats(vector<int64_t>& timings, const string& name) {
-    sort(timings.begin(), timings.end());
+TEST(test_metrics_registry_export) {
+    MetricsRegistry registry;
+    {
+        OrderBook a, b;
+        ASSERT(a.attach_metrics(registry, "A"), "Attach should succeed");
+        ASSERT(b.attach_metrics(registry, "B"), "Attach should succeed");
+
+        a.add_order(Order(1, true, 100.0, 10, 1000));
+        b.add_order(Order(1, true, 100.0, 10, 1000));
+        b.add_order(Order(2, false, 101.0, 10, 1000));
+
+        MetricsSnapshot total = registry.total();
+        ASSERT(total.resting_orders == 3, "Total should sum both books");
+        ASSERT(total.messages == 3, "Messages should sum both books");
+
+        string path = "orderbook_metrics_test.txt";
+        MetricsExporter exporter(registry, path);
+        ASSERT(exporter.export_now(), "Export should succeed");
+
+        FILE* f = fopen(path.c_str(), "r");
+        ASSERT(f != nullptr, "Export file should exist");
+        char buf[4096];
+        size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+        buf[n] = '\0';
+        fclose(f);
+        remove(path.c_str());
+        ASSERT(strstr(buf, "orderbook_resting_orders{book=\"all\"} 3") != nullptr,
+               "Export should contain aggregated gauge");
+    }
 
-    BenchmarkResult result;
-    result.name = name;
+    // released blocks are no longer aggregated
+    ASSERT(registry.total().resting_orders == 0, "Released books should be skipped");
+}
 
-    double sum = accumulate(timings.begin(), timings.end(), 0.0);
-    result.avg_ns = sum / timings.size();
-    result.median_ns = timings[timings.size() / 2];
-    result.min_ns = timings.front();
-    result.max_ns = timings.back();
-    result.p95_ns = timings[static_cast<size_t>(timings.size() * 0.95)];
-    result.p99_ns = timings[static_cast<size_t>(timings.size() * 0.99)];
+TEST(test_duplicate_order_id_rejected) {
+    OrderBook book;
 
-    return result;
+    ASSERT(book.add_order(Order(1, true, 100.0, 10, 1000)), "First add should succeed");
+    ASSERT(!book.add_order(Order(1, false, 101.0, 20, 2000)), "Duplicate id should be rejected");
+    ASSERT(book.get_total_orders() == 1, "Should have 1 order");
+    ASSERT(book.get_ask_levels() == 0, "Rejected order must not create a level");
 }
 
-void benchmark_add_order() {
-    const int NUM_ITERATIONS = 100000;
-    vector<int64_t> timings;
-    timings.reserve(NUM_ITERATIONS);
+TEST(test_order_index_churn) {
+    OrderBook book;
+    mt19937_64 rng(42);
+    vector<uint64_t> live;
+
+    // random ids with interleaved cancels exercise probing and backward shift
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t id = rng();
+        book.add_order(Order(id, id % 2 == 0, 100.0 + (id % 50), 10, i));
+        live.push_back(id);
+        if (i % 3 == 0) {
+            size_t pick = rng() % live.size();
+            ASSERT(book.cancel_order(live[pick]), "Cancel of live order should succeed");
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+    ASSERT(book.get_total_orders() == live.size(), "Index size should match live orders");
+    for (uint64_t id : live) {
+        ASSERT(book.amend_order(id, 100.0 + (id % 50), 5), "Every live order should be found");
+    }
+}
 
+TEST(test_order_index_memory) {
     OrderBook book;
-    Timer timer;
+    const size_t n = 100000;
+    book.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        book.add_order(Order(i * 7919, i % 2 == 0, 100.0 + (i % 100), 10, i));
+    }
+    ASSERT(book.get_index_memory() / n < 16, "Index overhead should stay below 16 bytes per order");
+
+    // worst case without reserve: the order right after each grow
+    OrderBook grown;
+    size_t buckets = grown.get_index_memory(), grows = 0;
+    for (size_t i = 1; i <= 200000; ++i) {
+        grown.add_order(Order(i * 7919, i % 2 == 0, 100.0 + (i % 100), 10, i));
+        if (grown.get_index_memory() != buckets) {
+            buckets = grown.get_index_memory();
+            ++grows;
+            ASSERT(double(buckets) / double(i) < 16.0, "Just past a grow should stay below 16 bytes per order");
+        }
+    }
+    ASSERT(grows >= 10, "Growth should be exercised repeatedly");
+}
+
+TEST(test_memory_pool_handles) {
+    MemoryPool<Order, 4096> pool;
 
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        double price = 100.0 + (i % 100) * 0.01;
-        timer.reset();
-        book.add_order(Order(i, i % 2 == 0, price, 100, i));
-        timings.push_back(timer.elapsed_ns());
+    vector<uint32_t> handles;
+    for (int i = 0; i < 1000; ++i) {
+        handles.push_back(pool.allocate(i, i % 2 == 0, 100.0 + i, 10 + i, i));
     }
+    ASSERT(pool.size() == 1000, "Pool should hold 1000 objects");
+
+    // freed handles are reused before the pool grows
+    size_t capacity = pool.capacity();
+    pool.deallocate(handles[10]);
+    pool.deallocate(handles[20]);
+    uint32_t a = pool.allocate(5000, true, 1.0, 1, 0);
+    uint32_t b = pool.allocate(5001, true, 1.0, 1, 0);
+    ASSERT((a == handles[20] && b == handles[10]), "Freed handles should be recycled");
+    ASSERT(pool.capacity() == capacity, "Recycling should not grow the pool");
+    ASSERT(pool.at(handles[999]).order_id == 999, "Handles should resolve across slabs");
+}
+
+TEST(test_memory_pool_flat_snapshot) {
+    MemoryPool<Order, 4096> pool;
+    vector<uint32_t> handles;
+    for (int i = 0; i < 500; ++i) {
+        handles.push_back(pool.allocate(i, true, 100.0 + i, i, i));
+    }
+    pool.deallocate(handles[7]);
 
-    auto result = calculate_stats(timings, "Add Order");
-    result.print();
+    vector<uint8_t> image;
+    pool.save(image);
+
+    MemoryPool<Order, 4096> copy;
+    ASSERT(copy.load(image.data(), image.size()), "Load should accept a saved image");
+    ASSERT(copy.size() == 499, "Restored pool should keep its size");
+    ASSERT(copy.at(handles[321]).quantity == 321, "Handles should stay valid after restore");
+    ASSERT(copy.allocate(9999, true, 1.0, 1, 0) == handles[7], "Free list should survive restore");
 }
 
-void benchmark_cancel_order() {
-    const int NUM_ITERATIONS = 100000;
-    OrderBook book;
+TEST(test_cancel_all_for_owner) {
+    for (bool columns : {false, true}) {
+        OrderBook book(columns);
+        for (int i = 0; i < 100; ++i) {
+            book.add_order(Order(i, i % 2 == 0, 100.0 + (i % 10), 10, i, i % 4));
+        }
+        ASSERT(book.get_owner_quantity(1) == 250, "Owner 1 should hold 25 orders of 10");
+
+        size_t removed = book.cancel_all_for_owner(1);
+        ASSERT(removed == 25, "Should cancel 25 orders of owner 1");
+        ASSERT(book.get_total_orders() == 75, "Should have 75 orders left");
+        ASSERT(book.get_owner_quantity(1) == 0, "Owner 1 should have nothing left");
+        ASSERT(!book.cancel_order(1), "Owner 1 orders should be gone");
+        ASSERT(book.cancel_order(2), "Other owners should be untouched");
+    }
+}
 
-    // Pre-populate the book
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        double price = 100.0 + (i % 100) * 0.01;
-        book.add_order(Order(i, i % 2 == 0, price, 100, i));
+TEST(test_expired_order_scan) {
+    for (bool columns : {false, true}) {
+        OrderBook book(columns);
+        book.add_order(Order(1, true, 100.0, 10, 0, 0, 5000));
+        book.add_order(Order(2, true, 100.0, 10, 0, 0, 0));      // GTC
+        book.add_order(Order(3, false, 101.0, 10, 0, 0, 9000));
+        book.add_order(Order(4, false, 101.0, 10, 0, 0, 4000));
+
+        vector<uint64_t> ids;
+        book.get_expired_orders(5000, ids);
+        sort(ids.begin(), ids.end());
+        ASSERT((ids == vector<uint64_t>{1, 4}), "Orders 1 and 4 should be expired at 5000");
+
+        // expiry survives a price amend
+        book.amend_order(3, 102.0, 10);
+        book.get_expired_orders(10000, ids);
+        ASSERT(ids.size() == 3, "GTC order should never expire");
     }
+}
 
-    vector<int64_t> timings;
-    timings.reserve(NUM_ITERATIONS);
+TEST(test_timer_wheel_random) {
+    TimerWheel wheel;
+    mt19937_64 rng(7);
+    vector<uint64_t> expiry(5000, 0);  // 0 = not scheduled
 
-    Timer timer;
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        timer.reset();
-        book.cancel_order(i);
-        timings.push_back(timer.elapsed_ns());
+    // spread from microseconds to beyond the ~19.5h horizon
+    for (uint32_t h = 0; h < expiry.size(); ++h) {
+        uint64_t span = uint64_t(1) << (10 + rng() % 38);
+        expiry[h] = 1 + rng() % span;
+        ASSERT(wheel.schedule(h, expiry[h]), "Future expiry should be accepted");
+    }
+    for (uint32_t h = 0; h < expiry.size(); h += 7) {
+        wheel.cancel(h);
+        expiry[h] = 0;
     }
 
-    auto result = calculate_stats(timings, "Cancel Order");
-    result.print();
+    uint64_t now = 0;
+    size_t remaining = wheel.size();
+    for (int step = 0; step < 200 && remaining; ++step) {
+        now += uint64_t(1) << (rng() % 42);
+        vector<uint32_t> fired;
+        wheel.advance(now, [&](uint32_t h) { fired.push_back(h); });
+
+        for (uint32_t h : fired) {
+            ASSERT(expiry[h] != 0, "Cancelled timer must not fire");
+            ASSERT(expiry[h] <= now, "Timer must not fire early");
+            expiry[h] = 0;
+        }
+        for (uint32_t h = 0; h < expiry.size(); ++h) {
+            // due timers fire on the call that reaches them, mid-tick included
+            ASSERT(expiry[h] == 0 || expiry[h] > now, "Due timer should have fired");
+        }
+        remaining -= fired.size();
+        ASSERT(wheel.size() == remaining, "Wheel size should track outstanding timers");
+    }
 }
 
-void benchmark_amend_order_quantity() {
-    const int NUM_ITERATIONS = 10000;
+TEST(test_order_expiry) {
     OrderBook book;
+    const uint64_t open = 1000000000;  // book clock in ns
 
-    // Pre-populate the book
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        double price = 100.0 + (i % 100) * 0.01;
-        book.add_order(Order(i, true, price, 100, i));
+    book.add_order(Order(1, true, 100.0, 10, open, 0, open + 5000000));   // GTT +5ms
+    book.add_order(Order(2, true, 100.0, 20, open, 0, 0));                // GTC
+    book.add_order(Order(3, false, 101.0, 30, open, 0, open + 9000000));  // GTT +9ms
+    book.add_order(Order(4, false, 102.0, 40, open, 0, open + 7000000));  // cancelled below
+    ASSERT(book.cancel_order(4), "Cancel of GTT order should succeed");
+
+    ASSERT(book.expire_orders(open + 1000000) == 0, "Nothing is due after 1ms");
+    ASSERT(book.expire_orders(open + 6000000) == 1, "Order 1 should expire at 5ms");
+    ASSERT(!book.cancel_order(1), "Expired order should be gone");
+
+    vector<PriceLevel> bids, asks;
+    book.get_snapshot(5, bids, asks);
+    ASSERT(bids[0].total_quantity == 20, "Only the GTC bid should remain");
+
+    ASSERT(book.expire_orders(open + 10000000) == 1, "Order 3 should expire at 9ms");
+    ASSERT(book.get_ask_levels() == 0, "Expiry should remove empty levels");
+    ASSERT(book.get_counters().orders_expired.load() == 2, "Should count 2 expiries");
+
+    // an order that arrives already past its expiry is rejected
+    ASSERT(!book.add_order(Order(5, true, 99.0, 10, open + 10000000, 0, open + 9500000)),
+           "Already expired order should be rejected");
+
+    // expiry is exact to the nanosecond, also inside a 1024 ns wheel tick,
+    // and agrees with the get_expired_orders() audit
+    const uint64_t at = open + 20000000 + 300;
+    ASSERT(book.add_order(Order(6, true, 99.0, 10, open + 10000000, 0, at)), "GTT add should succeed");
+    vector<uint64_t> ids;
+    ASSERT(book.expire_orders(at - 1) == 0, "Not due one ns early");
+    book.get_expired_orders(at - 1, ids);
+    ASSERT(ids.empty(), "Audit agrees one ns early");
+    book.get_expired_orders(at, ids);
+    ASSERT(ids == vector<uint64_t>{6}, "Audit reports it at its expiry");
+    ASSERT(book.expire_orders(at) == 1, "Due at its exact expiry");
+    ASSERT(!book.add_order(Order(7, true, 99.0, 10, at, 0, at)), "Expiry equal to the clock is already due");
+
+    // with another timer armed the wheel keeps its own clock, and the add's
+    // timestamp still decides
+    ASSERT(book.add_order(Order(8, true, 99.0, 10, at, 0, at + 50000000)), "Future GTT add should succeed");
+    ASSERT(!book.add_order(Order(9, true, 99.0, 10, at + 2000000, 0, at + 1000000)),
+           "Add already past its expiry is rejected whatever else is armed");
+    book.get_expired_orders(at + 2000000, ids);
+    ASSERT(ids.empty() && book.get_total_orders() == 2, "Nothing expired rests");
+}
+
+// ladder + direct index book for a 0.01 tick; 512 levels a side, ids < 1M
+using TestLadderBook = BasicOrderBook<LadderConfig<100, 512, 1000000>>;
+
+TEST(test_policy_books_agree) {
+    OrderBook tree_book;
+    TestLadderBook ladder_book;
+    mt19937_64 rng(7);
+    vector<pair<uint64_t, int>> live;   // id, price in ticks
+
+    for (uint64_t id = 1; id < 20000; ++id) {
+        unsigned roll = rng() % 10;
+        if (live.empty() || roll < 5) {
+            bool is_buy = rng() & 1;
+            int ticks = is_buy ? 9990 - int(rng() % 100) : 10010 + int(rng() % 100);
+            uint64_t qty = 1 + rng() % 100;
+            ASSERT(tree_book.add_order(Order(id, is_buy, ticks * 0.01, qty, id)) ==
+                   ladder_book.add_order(Order(id, is_buy, ticks * 0.01, qty, id)), "Add results should match");
+            live.emplace_back(id, ticks);
+        } else if (roll < 8) {
+            size_t pick = rng() % live.size();
+            ASSERT(tree_book.cancel_order(live[pick].first) == ladder_book.cancel_order(live[pick].first),
+                   "Cancel results should match");
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            auto& [oid, ticks] = live[rng() % live.size()];
+            if (rng() % 2) ticks += int(rng() % 5);
+            uint64_t qty = 1 + rng() % 100;
+            ASSERT(tree_book.amend_order(oid, ticks * 0.01, qty) == ladder_book.amend_order(oid, ticks * 0.01, qty),
+                   "Amend results should match");
+        }
     }
 
-    vector<int64_t> timings;
-    timings.reserve(NUM_ITERATIONS);
+    vector<PriceLevel> tb, ta, lb, la;
+    tree_book.get_snapshot(1000, tb, ta);
+    ladder_book.get_snapshot(1000, lb, la);
+    ASSERT(tb.size() == lb.size() && ta.size() == la.size(), "Level counts should match");
+    for (size_t i = 0; i < tb.size(); ++i) {
+        ASSERT(fabs(tb[i].price - lb[i].price) < 1e-9 && tb[i].total_quantity == lb[i].total_quantity,
+               "Bid levels should match");
+    }
+    for (size_t i = 0; i < ta.size(); ++i) {
+        ASSERT(fabs(ta[i].price - la[i].price) < 1e-9 && ta[i].total_quantity == la[i].total_quantity,
+               "Ask levels should match");
+    }
+    ASSERT(tree_book.get_total_orders() == ladder_book.get_total_orders(), "Order counts should match");
+}
 
-    Timer timer;
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        double price = 100.0 + (i % 100) * 0.01;
-        timer.reset();
-        book.amend_order(i, price, 200);
-        timings.push_back(timer.elapsed_ns());
+TEST(test_ladder_band_and_direct_ids) {
+    TestLadderBook book;
+
+    ASSERT(book.add_order(Order(1, true, 100.00, 10, 1)), "First bid anchors the ladder");
+    ASSERT(book.add_order(Order(2, true, 102.55, 10, 2)), "Within 256 ticks above the anchor");
+    ASSERT(!book.add_order(Order(3, true, 102.56, 10, 3)), "Past the ladder window should be rejected");
+    ASSERT(!book.add_order(Order(4, true, 97.43, 10, 4)), "Below the ladder window should be rejected");
+    ASSERT(!book.add_order(Order(1000000, false, 101.0, 10, 5)), "Id past the direct index should be rejected");
+    ASSERT(book.get_counters().rejects.load() == 3, "Should count 3 rejects");
+
+    // once a side empties it re-anchors on the next price
+    ASSERT(book.cancel_order(1) && book.cancel_order(2), "Cancels should succeed");
+    ASSERT(book.add_order(Order(3, true, 150.00, 10, 6)), "Empty side should re-anchor");
+
+    vector<PriceLevel> bids, asks;
+    book.get_snapshot(5, bids, asks);
+    ASSERT(bids.size() == 1 && fabs(bids[0].price - 150.0) < 1e-9, "Best bid should be 150.00");
+}
+
+// 0.25 tick with a +-100.00 band; 0.01 tick with a band too wide to ladder
+using TestQuarterTick = Instrument<25, 100, 400>;
+using TestWideBand = Instrument<1, 100, 100000, 4096>;
+
+static_assert(TestQuarterTick::kTickNum == 1 && TestQuarterTick::kTickDen == 4, "tick reduces to 1/4");
+static_assert(TestQuarterTick::kLadderLevels == 1024, "801 band slots round up to 1024");
+static_assert(TestQuarterTick::kUseLadder && !TestWideBand::kUseLadder, "ladder only when it fits");
+
+TEST(test_instrument_configured_books) {
+    BasicOrderBook<InstrumentConfig<TestQuarterTick, 1000>> book;
+
+    ASSERT(book.add_order(Order(1, true, 4500.25, 10, 1)), "On-grid bid should be accepted");
+    ASSERT(book.add_order(Order(2, true, 4500.30, 5, 2)), "Off-grid price snaps to the nearest tick");
+    ASSERT(book.add_order(Order(3, false, 4600.00, 7, 3)), "Ask 100.00 away anchors its own side");
+    ASSERT(!book.add_order(Order(4, true, 4500.25 + 0.25 * 600, 1, 4)), "Bid past the band should be rejected");
+
+    vector<PriceLevel> bids, asks;
+    book.get_snapshot(5, bids, asks);
+    ASSERT(bids.size() == 1 && bids[0].price == 4500.25 && bids[0].total_quantity == 15,
+           "Both bids should share the 4500.25 level");
+    ASSERT(asks.size() == 1 && asks[0].price == 4600.0, "Ask should be 4600.00");
+
+    // too wide for the ladder budget: falls back to the tree side
+    BasicOrderBook<InstrumentConfig<TestWideBand>> wide;
+    ASSERT(wide.add_order(Order(1, true, 100.01, 10, 1)), "Add should succeed");
+    ASSERT(wide.add_order(Order(2, true, 900.01, 10, 2)), "Tree side has no band");
+    ASSERT(wide.get_bid_levels() == 2, "Should have 2 bid levels");
+}
+
+TEST(test_options_chain_matches_books) {
+    const uint32_t SERIES = 40;
+    OptionsChain chain(SERIES);
+    vector<unique_ptr<OrderBook>> books;
+    for (uint32_t i = 0; i < SERIES; ++i) books.emplace_back(new OrderBook());
+
+    mt19937_64 rng(11);
+    vector<pair<uint64_t, uint32_t>> live;   // id, series
+    for (uint64_t id = 1; id < 20000; ++id) {
+        unsigned roll = rng() % 10;
+        if (live.empty() || roll < 5) {
+            // series 0 is busy enough to spill its levels to the heap
+            uint32_t series = rng() % 4 == 0 ? 0 : uint32_t(rng() % SERIES);
+            bool is_buy = rng() & 1;
+            double price = (is_buy ? 500 - int(rng() % 30) : 510 + int(rng() % 30)) * 0.05;
+            Order o(id, is_buy, price, 1 + rng() % 50, id);
+            ASSERT(chain.add_order(series, o) && books[series]->add_order(o), "Add should succeed");
+            live.emplace_back(id, series);
+        } else if (roll < 8) {
+            size_t pick = rng() % live.size();
+            auto [oid, series] = live[pick];
+            ASSERT(chain.cancel_order(oid) && books[series]->cancel_order(oid), "Cancel should succeed");
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            auto [oid, series] = live[rng() % live.size()];
+            double price = (500 - int(rng() % 30)) * 0.05;
+            uint64_t qty = rng() % 50;   // 0 removes the order
+            bool expected = books[series]->amend_order(oid, price, qty);
+            ASSERT(chain.amend_order(oid, price, qty) == expected, "Amend results should match");
+            if (qty == 0) {
+                live.erase(find(live.begin(), live.end(), make_pair(oid, series)));
+            }
+        }
+    }
+
+    size_t total = 0;
+    for (uint32_t i = 0; i < SERIES; ++i) {
+        vector<PriceLevel> cb, ca, bb, ba;
+        chain.get_snapshot(i, 1000, cb, ca);
+        books[i]->get_snapshot(1000, bb, ba);
+        ASSERT(cb.size() == bb.size() && ca.size() == ba.size(), "Level counts should match");
+        for (size_t j = 0; j < cb.size(); ++j) {
+            ASSERT(cb[j].price == bb[j].price && cb[j].total_quantity == bb[j].total_quantity, "Bids should match");
+        }
+        for (size_t j = 0; j < ca.size(); ++j) {
+            ASSERT(ca[j].price == ba[j].price && ca[j].total_quantity == ba[j].total_quantity, "Asks should match");
+        }
+        total += books[i]->get_total_orders();
+    }
+    ASSERT(chain.get_total_orders() == total, "Order counts should match");
+    ASSERT(chain.get_levels(0, true) > 2, "Busy series should have spilled past the inline levels");
+    if (!live.empty()) {
+        ASSERT(chain.series_of(live[0].first) == live[0].second, "series_of should find the order");
     }
 
-    auto result = calculate_stats(timings, "Amend Order (Quantity)");
-    result.print();
+    // ids are unique across the chain, and unknown series are rejected
+    ASSERT(!live.empty() && !chain.add_order(1, Order(live[0].first, true, 1.0, 1, 0)),
+           "Duplicate id in another series should be rejected");
+    ASSERT(!chain.add_order(SERIES, Order(999999, true, 1.0, 1, 0)), "Unknown series should be rejected");
 }
 
-void benchmark_amend_order_price() {
-    const int NUM_ITERATIONS = 10000;
-    OrderBook book;
+TEST(test_implied_calendar_spread) {
+    OrderBook front, back, other;
+    ImpliedBook implied;
+    uint32_t f = implied.add_leg(), b = implied.add_leg(), o = implied.add_leg();
+    uint32_t spread = implied.add_calendar_spread(f, b);   // front - back
+
+    ASSERT(implied.implied(spread).bid.total_quantity == 0, "No legs, no implied price");
+
+    front.add_order(Order(1, true, 100.00, 10, 1));
+    front.add_order(Order(2, false, 100.50, 4, 2));
+    back.add_order(Order(3, true, 101.00, 7, 3));
+    back.add_order(Order(4, false, 101.25, 5, 4));
+    implied.on_leg_book(f, front);
+    implied.on_leg_book(b, back);
+
+    const TopOfBook& top = implied.implied(spread);
+    ASSERT(fabs(top.bid.price - (100.00 - 101.25)) < 1e-9 && top.bid.total_quantity == 5,
+           "Implied bid = front bid - back ask, min qty");
+    ASSERT(fabs(top.ask.price - (100.50 - 101.00)) < 1e-9 && top.ask.total_quantity == 4,
+           "Implied ask = front ask - back bid, min qty");
+
+    vector<uint32_t> changed;
+    implied.drain_changed(changed);
+    ASSERT(changed.size() == 1 && changed[0] == spread, "Spread should be reported once");
+
+    // a front-leg bid change recomputes only the spread bid
+    uint64_t before = implied.recomputations();
+    front.add_order(Order(5, true, 100.10, 3, 5));
+    ASSERT(implied.on_leg_book(f, front) == 1, "Only the spread bid depends on the front bid");
+    ASSERT(implied.recomputations() == before + 1, "One recomputation");
+    ASSERT(fabs(implied.implied(spread).bid.price - (100.10 - 101.25)) < 1e-9, "Bid should follow the front leg");
+
+    // a change below the top, or on an unrelated leg, recomputes nothing
+    before = implied.recomputations();
+    front.add_order(Order(6, true, 99.00, 3, 6));
+    ASSERT(implied.on_leg_book(f, front) == 0, "Depth change should not recompute");
+    other.add_order(Order(7, true, 50.0, 1, 7));
+    ASSERT(implied.on_leg_book(o, other) == 0, "Unrelated leg should not recompute");
+    ASSERT(implied.recomputations() == before, "No recomputations");
+
+    // emptying the back ask removes the implied bid
+    back.cancel_order(4);
+    implied.on_leg_book(b, back);
+    ASSERT(implied.implied(spread).bid.total_quantity == 0, "No back ask, no implied bid");
+    implied.drain_changed(changed);
+    ASSERT(changed.size() == 1, "Spread should be reported again");
+}
 
-    // Pre-populate the book
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        double price = 100.0 + (i % 100) * 0.01;
-        book.add_order(Order(i, true, price, 100, i));
+TEST(test_consolidated_book_from_deltas) {
+    const size_t VENUES = 3;
+    OrderBook venues[VENUES];
+    vector<LevelDelta> deltas[VENUES];
+    ConsolidatedBook nbbo;
+    BasicConsolidatedBook<LadderConfig<100, 1024, 1>> ladder_nbbo;
+    for (size_t v = 0; v < VENUES; ++v) venues[v].set_delta_sink(&deltas[v]);
+
+    mt19937_64 rng(5);
+    vector<pair<uint64_t, size_t>> live;
+    for (uint64_t id = 1; id < 10000; ++id) {
+        size_t v = rng() % VENUES;
+        unsigned roll = rng() % 10;
+        if (live.empty() || roll < 5) {
+            bool is_buy = rng() & 1;
+            double price = (is_buy ? 9990 - int(rng() % 20) : 10000 + int(rng() % 20)) * 0.01;
+            venues[v].add_order(Order(id, is_buy, price, 1 + rng() % 100, id));
+            live.emplace_back(id, v);
+        } else if (roll < 8) {
+            size_t pick = rng() % live.size();
+            v = live[pick].second;
+            venues[v].cancel_order(live[pick].first);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            auto [oid, ov] = live[rng() % live.size()];
+            v = ov;
+            venues[v].amend_order(oid, (9990 - int(rng() % 20)) * 0.01, 1 + rng() % 100);
+        }
+        nbbo.apply(v, deltas[v]);
+        ladder_nbbo.apply(v, deltas[v]);
+        deltas[v].clear();
     }
 
-    vector<int64_t> timings;
-    timings.reserve(NUM_ITERATIONS);
+    // brute force: merge every venue's full depth
+    map<double, uint64_t> merged_bids, merged_asks;
+    for (size_t v = 0; v < VENUES; ++v) {
+        vector<PriceLevel> b, a;
+        venues[v].get_snapshot(1000, b, a);
+        for (auto& l : b) {
+            merged_bids[l.price] += l.total_quantity;
+            ASSERT(nbbo.venue_quantity(true, l.price, v) == l.total_quantity, "Venue attribution should match");
+            ASSERT(venues[v].level_quantity(true, l.price) == l.total_quantity, "level_quantity should match");
+        }
+        for (auto& l : a) merged_asks[l.price] += l.total_quantity;
+    }
 
-    Timer timer;
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        double old_price = 100.0 + (i % 100) * 0.01;
-        double new_price = old_price + 0.01;
-        timer.reset();
-        book.amend_order(i, new_price, 100);
-        timings.push_back(timer.elapsed_ns());
+    vector<PriceLevel> cb, ca, lb, la;
+    nbbo.get_snapshot(1000, cb, ca);
+    ladder_nbbo.get_snapshot(1000, lb, la);
+    ASSERT(cb.size() == merged_bids.size() && ca.size() == merged_asks.size(), "Level counts should match");
+    ASSERT(lb.size() == cb.size() && la.size() == ca.size(), "Ladder consolidation should match");
+    size_t i = 0;
+    for (auto it = merged_bids.rbegin(); it != merged_bids.rend(); ++it, ++i) {
+        ASSERT(cb[i].price == it->first && cb[i].total_quantity == it->second, "Bid levels should match");
+        ASSERT(fabs(lb[i].price - it->first) < 1e-9 && lb[i].total_quantity == it->second, "Ladder bids should match");
+    }
+    i = 0;
+    for (auto& [price, qty] : merged_asks) {
+        ASSERT(ca[i].price == price && ca[i].total_quantity == qty, "Ask levels should match");
+        ++i;
     }
 
-    auto result = calculate_stats(timings, "Amend Order (Price)");
-    result.print();
+    // best-bid attribution and venue disconnect
+    TopOfBook top = nbbo.get_top();
+    uint32_t mask = nbbo.best_venues(true);
+    for (size_t v = 0; v < VENUES; ++v) {
+        bool quotes = venues[v].level_quantity(true, top.bid.price) != 0;
+        ASSERT(bool(mask & (1u << v)) == quotes, "Best venue mask should match the venues");
+    }
+    nbbo.clear_venue(0);
+    ASSERT(nbbo.venue_quantity(true, top.bid.price, 0) == 0, "Disconnected venue should be gone");
+    ASSERT(!(nbbo.best_venues(true) & 1u), "Disconnected venue should not be at the best");
 }
 
-void benchmark_get_snapshot() {
-    const int NUM_ORDERS = 10000;
-    const int NUM_ITERATIONS = 100000;
+TEST(test_order_router_fees_and_optimality) {
+    VenueFees fees;
+    fees.take_fee[0] = 0.030;   // expensive venue
+    fees.take_fee[1] = 0.000;
+    fees.take_fee[2] = -0.002;  // rebate
+    OrderRouter<> router(fees);
+    RouteSlice slices[64];
+
+    // venue 0 shows the best raw price, but its fee makes venue 1 one tick
+    // worse cheaper overall
+    ConsolidatedBook book;
+    book.apply(0, LevelDelta{100.00, 100, false});
+    book.apply(1, LevelDelta{100.01, 100, false});
+    book.apply(2, LevelDelta{100.05, 500, false});
+
+    RouteResult r = router.route(book, true, 150, 101.0, slices, 64);
+    ASSERT(r.filled == 150 && r.slices == 2, "Should fill 150 in two slices");
+    ASSERT(slices[0].venue == 1 && slices[0].quantity == 100, "Cheapest effective price first");
+    ASSERT(slices[1].venue == 0 && slices[1].quantity == 50, "Then venue 0 at 100.03 effective");
+
+    r = router.route(book, true, 1000, 100.01, slices, 64);
+    ASSERT(r.filled == 200, "Limit price caps the levels taken");
+
+    // random books: the pruned walk matches a full sort of every candidate
+    mt19937_64 rng(9);
+    for (int round = 0; round < 200; ++round) {
+        ConsolidatedBook rb;
+        for (int i = 0; i < 40; ++i) {
+            bool is_buy = rng() & 1;
+            double price = (is_buy ? 9990 - int(rng() % 30) : 10000 + int(rng() % 30)) * 0.01;
+            rb.apply(rng() % 3, LevelDelta{price, 1 + rng() % 200, is_buy});
+        }
+        bool is_buy = rng() & 1;
+        uint64_t qty = 1 + rng() % 1500;
+        double limit = is_buy ? 1e9 : 0.0;
+
+        vector<tuple<double, uint64_t>> all;   // score, quantity
+        rb.walk(!is_buy, [&](double price, const ConsolidatedBook::Level& level) {
+            for (uint32_t v = 0; v < 3; ++v) {
+                if (level.venue_mask & (1u << v)) {
+                    double score = is_buy ? price + fees.take_fee[v] : -(price - fees.take_fee[v]);
+                    all.emplace_back(score, level.venue_quantity[v]);
+                }
+            }
+            return true;
+        });
+        sort(all.begin(), all.end());
+        double best_cost = 0;
+        uint64_t left = qty;
+        for (auto& [score, q] : all) {
+            uint64_t take = min(left, q);
+            best_cost += score * double(take);
+            left -= take;
+        }
+
+        r = router.route(rb, is_buy, qty, limit, slices, 64);
+        double cost = is_buy ? r.notional + r.fees : -(r.notional - r.fees);
+        ASSERT(r.filled == qty - left, "Router should fill all available quantity");
+        ASSERT(fabs(cost - best_cost) < 1e-6, "Router cost should be optimal");
+    }
+}
 
-    OrderBook book;
+TEST(test_bar_aggregator_rollover_and_consumer) {
+    const uint64_t S = BarAggregator::kSecond;
+    BarAggregator agg(2);
+    vector<Bar> closed;
+    agg.set_bar_sink(&closed);
+
+    agg.on_fill(Fill{S / 10, 100.0, 10, 0, true, {}});
+    agg.on_fill(Fill{S / 2, 101.0, 5, 0, false, {}});
+    agg.on_fill(Fill{S / 3, 50.0, 7, 1, true, {}});
+    ASSERT(closed.empty(), "No bar should close inside its interval");
+
+    // a fill in the next second rolls symbol 0's 1s bar; symbol 1's quiet
+    // bar closes off the timer wheel
+    agg.on_fill(Fill{S + S / 5, 99.0, 1, 0, true, {}});
+    ASSERT(closed.size() == 2, "Both 1s bars should have closed");
+    const Bar& b = agg.completed(0, 0, 0);
+    ASSERT(b.start_ns == 0 && b.interval_ns == S, "Bar should cover the first second");
+    ASSERT(b.open == 100.0 && b.high == 101.0 && b.low == 100.0 && b.close == 101.0, "OHLC mismatch");
+    ASSERT(b.volume == 15 && b.buy_volume == 10 && b.trades == 2, "Volume mismatch");
+    ASSERT(fabs(b.vwap() - (1000.0 + 505.0) / 15.0) < 1e-12, "VWAP mismatch");
+    ASSERT(agg.current(0, 1) && agg.current(0, 1)->trades == 3, "1m bar keeps accumulating");
+
+    ASSERT(agg.advance(61 * S) == 3, "Remaining 1s and both 1m bars close on time");
+    ASSERT(!agg.current(0, 0) && !agg.current(1, 1), "Nothing should stay open");
+    ASSERT(agg.history(0, 1) == 1 && agg.completed(0, 1, 0).volume == 16, "1m bar holds all volume");
+    ASSERT(!agg.on_fill(Fill{62 * S, 1.0, 1, 2, true, {}}), "Unknown symbol should be rejected");
+
+    // random stream through the consumer thread and the columnar file,
+    // checked against a direct per-bucket computation
+    const size_t SYMBOLS = 4;
+    const string path = "test_bars.obb";
+    map<tuple<uint64_t, uint32_t, uint64_t>, Bar> expect;   // interval, symbol, start
+    vector<Bar> got;
+    {
+        BarConsumer consumer(SYMBOLS, path, 0, 1024);
+        ASSERT(consumer.start(), "Consumer should open its output file");
+        mt19937_64 rng(11);
+        uint64_t ts = 0;
+        for (int i = 0; i < 20000; ++i) {
+            ts += rng() % (20 * S / 1000);
+            Fill f{ts, double(9900 + rng() % 200) * 0.01, 1 + rng() % 100, uint32_t(rng() % SYMBOLS),
+                   bool(rng() & 1), {}};
+            while (!consumer.publish(f)) this_thread::yield();
+
+            for (uint64_t iv : {S, 60 * S}) {
+                Bar& e = expect[make_tuple(iv, f.symbol, ts - ts % iv)];
+                if (e.trades == 0) {
+                    e.start_ns = ts - ts % iv;
+                    e.interval_ns = iv;
+                    e.symbol = f.symbol;
+                    e.open = e.high = e.low = f.price;
+                }
+                e.high = max(e.high, f.price);
+                e.low = min(e.low, f.price);
+                e.close = f.price;
+                e.volume += f.quantity;
+                e.buy_volume += f.is_buy ? f.quantity : 0;
+                e.notional += f.price * double(f.quantity);
+                ++e.trades;
+            }
+        }
+        consumer.stop();
+        ASSERT(consumer.fills_consumed() == 20000, "Consumer should apply every fill");
+        ASSERT(!consumer.start(), "A stopped consumer must not reopen (truncate) its file");
+    }
+    ASSERT(read_bar_file(path, got), "Bar file should read back");
+    remove(path.c_str());
+
+    ASSERT(got.size() == expect.size(), "One bar per traded (interval, symbol, bucket)");
+    for (const Bar& g : got) {
+        auto it = expect.find(make_tuple(g.interval_ns, g.symbol, g.start_ns));
+        ASSERT(it != expect.end(), "Unexpected bar in file");
+        const Bar& e = it->second;
+        ASSERT(g.open == e.open && g.high == e.high && g.low == e.low && g.close == e.close, "OHLC mismatch");
+        ASSERT(g.volume == e.volume && g.buy_volume == e.buy_volume && g.trades == e.trades, "Volume mismatch");
+        ASSERT(fabs(g.vwap() - e.vwap()) < 1e-9, "VWAP mismatch");
+    }
+}
 
-    // Pre-populate the book
-    for (int i = 0; i < NUM_ORDERS; ++i) {
-        double price = 100.0 + (i % 1000) * 0.01;
-        book.add_order(Order(i, i % 2 == 0, price, 100, i));
+TEST(test_columnar_file_roundtrip_and_seek) {
+    // three and a bit chunks of mixed flow: grid and off-grid prices,
+    // expiries on both sides of the timestamp, ids moving both ways
+    mt19937_64 rng(13);
+    vector<OrderEvent> events;
+    uint64_t ts = 34200ull * 1000000000ull;
+    for (uint64_t i = 0; i < 3 * ColumnarWriter::kChunkEvents + 123; ++i) {
+        ts += rng() % 5000;
+        uint64_t id = 1 + rng() % 100000;
+        unsigned roll = rng() % 3;
+        if (roll == 0) {
+            double price = rng() % 10 ? double(9900 + int(rng() % 200)) / 100.0 : 100.0 + 1.0 / 3.0;
+            uint64_t expiry = rng() % 4 ? 0 : ts + rng() % 2000000 - 1000000;
+            events.push_back(OrderEvent::add(Order(id, rng() & 1, price, 1 + rng() % 1000, ts,
+                                                   uint32_t(rng() % 70000), expiry)));
+        } else if (roll == 1) {
+            events.push_back(OrderEvent::cancel(id, ts));
+        } else {
+            events.push_back(OrderEvent::amend(id, double(9900 + int(rng() % 200)) / 100.0, rng() % 1000, ts));
+        }
     }
 
-    vector<int64_t> timings;
-    timings.reserve(NUM_ITERATIONS);
+    const string path = "test_events.obc";
+    {
+        ColumnarWriter writer(path, 100);
+        ASSERT(writer.is_open(), "Writer should open");
+        ASSERT(writer.write(events.data(), events.size()), "Writes should succeed");
+        ASSERT(writer.close(), "Close should succeed");
+    }
 
-    vector<PriceLevel> bids, asks;
-    Timer timer;
+    ColumnarReader reader(path);
+    ASSERT(reader.is_open() && reader.size() == events.size(), "Reader should see every event");
+    ASSERT(reader.chunks() == 4, "Events should split into 4 chunks");
+    ColumnarReader closed;
+    ASSERT(!closed.is_open() && closed.ticks_per_unit() == 0 && closed.size() == 0, "Unopened reader is empty");
+    ASSERT(reader.file_bytes() < events.size() * sizeof(OrderEvent) / 3, "Columns should compress");
+
+    vector<OrderEvent> back;
+    ASSERT(reader.read_all(back) && back.size() == events.size(), "read_all should decode everything");
+    for (size_t i = 0; i < events.size(); ++i) {
+        ASSERT(memcmp(&back[i], &events[i], sizeof(OrderEvent)) == 0, "Event should round-trip exactly");
+    }
+
+    // seek: the chunk found for a timestamp holds the first event at or after it
+    vector<OrderEvent> chunk(reader.chunk_capacity());
+    for (int k = 0; k < 50; ++k) {
+        size_t target = rng() % events.size();
+        uint64_t t = events[target].timestamp_ns;
+        size_t c = reader.find_chunk(t);
+        ASSERT(c < reader.chunks() && reader.chunk(c).first_ts <= t && t <= reader.chunk(c).last_ts,
+               "find_chunk should land on the covering chunk");
+        size_t n = reader.decode(c, chunk.data());
+        ASSERT(n == reader.chunk(c).count, "Chunk should decode on its own");
+        auto first = lower_bound(events.begin(), events.end(), t,
+                                 [](const OrderEvent& e, uint64_t v) { return e.timestamp_ns < v; });
+        bool found = false;
+        for (size_t j = 0; j < n; ++j) found |= memcmp(&chunk[j], &*first, sizeof(OrderEvent)) == 0;
+        ASSERT(found, "Covering chunk should contain the first event at the timestamp");
+    }
+    ASSERT(reader.find_chunk(ts + 1) == reader.chunks(), "Seeking past the end finds no chunk");
+    remove(path.c_str());
+}
+
+TEST(test_columnar_snapshots_warm_start) {
+    // coherent flow (adds, cancels, amends, some GTT orders) with a book
+    // snapshot embedded every 3000 events
+    mt19937_64 rng(17);
+    vector<OrderEvent> events;
+    vector<pair<uint64_t, bool>> live;
+    uint64_t ts = 34200ull * 1000000000ull;
+    uint64_t next_id = 1;
+    for (int i = 0; i < 20000; ++i) {
+        ts += 1 + rng() % 2000;
+        unsigned roll = rng() % 100;
+        if (live.empty() || roll < 50) {
+            bool is_buy = rng() & 1;
+            double price = double(is_buy ? 9990 - int(rng() % 20) : 10000 + int(rng() % 20)) / 100.0;
+            uint64_t expiry = rng() % 8 ? 0 : ts + 100000 + rng() % 5000000;
+            events.push_back(OrderEvent::add(Order(next_id, is_buy, price, 1 + rng() % 100, ts, 0, expiry)));
+            live.emplace_back(next_id++, is_buy);
+        } else if (roll < 85) {
+            size_t pick = rng() % live.size();
+            events.push_back(OrderEvent::cancel(live[pick].first, ts));
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            auto [id, is_buy] = live[rng() % live.size()];
+            double price = double(is_buy ? 9990 - int(rng() % 20) : 10000 + int(rng() % 20)) / 100.0;
+            events.push_back(OrderEvent::amend(id, price, 1 + rng() % 100, ts));
+        }
+    }
 
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        timer.reset();
-        book.get_snapshot(10, bids, asks);
-        timings.push_back(timer.elapsed_ns());
+    auto step = [](OrderBook& book, const OrderEvent& ev) {
+        book.expire_orders(ev.timestamp_ns);
+        book.apply(ev);
+    };
+    auto same_orders = [](const OrderBook& a, const OrderBook& b) {
+        vector<Order> x, y;
+        a.get_orders(x);
+        b.get_orders(y);
+        if (x.size() != y.size()) return false;
+        for (size_t i = 0; i < x.size(); ++i) {
+            if (x[i].order_id != y[i].order_id || x[i].price != y[i].price ||
+                x[i].quantity != y[i].quantity || x[i].expiry_ns != y[i].expiry_ns) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const string path = "test_snapshots.obc";
+    {
+        ColumnarWriter writer(path);
+        OrderBook book;
+        vector<Order> orders;
+        for (size_t i = 0; i < events.size(); ++i) {
+            writer.write(events[i]);
+            step(book, events[i]);
+            if ((i + 1) % 3000 == 0) {
+                book.get_orders(orders);
+                ASSERT(writer.write_snapshot(events[i].timestamp_ns, orders), "Snapshot should write");
+            }
+        }
     }
 
-    auto result = calculate_stats(timings, "Get Snapshot (depth=10)");
-    result.print();
+    ColumnarReader reader(path);
+    ASSERT(reader.snapshots() == 6 && reader.size() == events.size(), "Six snapshots, every event kept");
+    vector<OrderEvent> all;
+    ASSERT(reader.read_all(all) && all.size() == events.size(), "Sequential reads skip snapshots");
+
+    for (size_t target : {size_t(0), size_t(2999), size_t(3000), size_t(3001), size_t(9876), size_t(19999)}) {
+        uint64_t t = events[target].timestamp_ns;
+        OrderBook expect;
+        size_t i = 0;
+        for (; i < events.size() && events[i].timestamp_ns < t; ++i) step(expect, events[i]);
+
+        OrderBook book;
+        ColumnarCursor cursor(reader);
+        uint64_t replayed = cursor.seek(book, t);
+        ASSERT(replayed <= 3000 + 1, "Warm start should replay at most one snapshot interval");
+        ASSERT(book.get_counters().messages.load() == replayed, "Snapshot restore is not counted as messages");
+        ASSERT(same_orders(book, expect), "Seeked book should match a replay from the open");
+
+        // the rest of the stream continues from exactly the first event at t
+        size_t n;
+        const OrderEvent* block = cursor.next(n);
+        ASSERT(block && memcmp(block, &events[i], sizeof(OrderEvent)) == 0, "Cursor should resume at t");
+        do {
+            for (size_t k = 0; k < n; ++k) step(book, block[k]);
+        } while ((block = cursor.next(n)));
+        for (; i < events.size(); ++i) step(expect, events[i]);
+        ASSERT(same_orders(book, expect), "Books should stay equal to the end of the stream");
+    }
+    remove(path.c_str());
 }
 
-void stress_test_large_book() {
-    cout << "\n" << string(70, '=') << "\n";
-    cout << "STRESS TEST: Large Order Book\n";
-    cout << string(70, '=') << "\n";
+TEST(test_stream_vbyte_roundtrip) {
+    // every length class and its boundaries, at counts around the 4- and
+    // 8-value SIMD steps so both the vector loop and the scalar tail run
+    const uint32_t edges[] = {0, 1, 255, 256, 65535, 65536, 16777215, 16777216, 0xffffffffu};
+    mt19937_64 rng(19);
+    for (size_t n : {size_t(0), size_t(1), size_t(3), size_t(4), size_t(7), size_t(8), size_t(9),
+                     size_t(31), size_t(64), size_t(1000), size_t(4099)}) {
+        vector<uint32_t> in(n), out(n + 8), ref(n + 8);
+        for (size_t i = 0; i < n; ++i) {
+            unsigned bits = unsigned(rng() % 33);
+            in[i] = rng() % 4 == 0 ? edges[rng() % 9] : uint32_t(rng() & ((uint64_t(1) << bits) - 1));
+        }
+
+        vector<uint8_t> buf(StreamVByte::max_encoded_bytes(n));
+        size_t bytes = StreamVByte::encode(in.data(), n, buf.data());
+        ASSERT(bytes <= StreamVByte::max_encoded_bytes(n) - 3, "Encoding should fit without the slack");
+        buf.resize(bytes);   // decoders must not read past the encoded bytes
+        ASSERT(StreamVByte::decode(buf.data(), bytes, n, out.data()) == bytes, "Decode should consume every byte");
+        ASSERT(StreamVByte::decode_scalar(buf.data(), n, ref.data()) == bytes, "Scalar decode should agree on length");
+        ASSERT(equal(in.begin(), in.end(), out.begin()) && equal(in.begin(), in.end(), ref.begin()),
+               "Values should round-trip");
+
+        // deltas of a wandering sequence, including wrap-around steps
+        uint32_t x = uint32_t(rng());
+        for (size_t i = 0; i < n; ++i) {
+            x += rng() % 8 == 0 ? uint32_t(rng()) : uint32_t(int32_t(rng() % 2001) - 1000);
+            in[i] = x;
+        }
+        buf.assign(StreamVByte::max_encoded_bytes(n), 0);
+        bytes = StreamVByte::encode_delta(in.data(), n, buf.data(), 12345);
+        buf.resize(bytes);
+        ASSERT(StreamVByte::decode_delta(buf.data(), bytes, n, out.data(), 12345) == bytes, "Delta decode length");
+        StreamVByte::decode_delta_scalar(buf.data(), n, ref.data(), 12345);
+        ASSERT(equal(in.begin(), in.end(), out.begin()) && equal(in.begin(), in.end(), ref.begin()),
+               "Deltas should round-trip");
+    }
 
-    const int NUM_ORDERS = 100000;
-    OrderBook book;
+    // small deltas stay at one byte per value plus the control stream
+    vector<uint32_t> ids(4096);
+    iota(ids.begin(), ids.end(), 1000000u);
+    vector<uint8_t> buf(StreamVByte::max_encoded_bytes(ids.size()));
+    ASSERT(StreamVByte::encode_delta(ids.data(), ids.size(), buf.data(), 999999) == 4096 + 1024,
+           "Unit deltas should take 1.25 bytes per value");
+}
+
+TEST(test_book_checksum_and_diff) {
+    using RefBook = BasicOrderBook<WithChecksum<DefaultConfig>>;
+    using LadBook = BasicOrderBook<WithChecksum<LadderConfig<100, 512, 1000000>>>;
+
+    // different configs, same flow: checksums agree after every event
+    RefBook a;
+    LadBook b;
+    mt19937_64 rng(23);
+    vector<uint64_t> live;
+    unordered_map<uint64_t, double> price_of;
+    uint64_t next_id = 1;
+    for (uint64_t ts = 1; ts <= 20000; ++ts) {
+        OrderEvent ev;
+        unsigned roll = rng() % 10;
+        if (live.empty() || roll < 5) {
+            bool is_buy = rng() & 1;
+            double price = double(10000 + (is_buy ? -1 : 1) * int64_t(1 + rng() % 30)) / 100.0;
+            ev = OrderEvent::add(Order(next_id, is_buy, price, 1 + rng() % 100, ts));
+            price_of[next_id] = price;
+            live.push_back(next_id++);
+        } else {
+            // cancels, and quantity amends down to 0 which also remove
+            size_t pick = rng() % live.size();
+            uint64_t id = live[pick];
+            ev = roll < 8 ? OrderEvent::cancel(id, ts) : OrderEvent::amend(id, price_of[id], rng() % 50, ts);
+            if (ev.type == EventType::Cancel || ev.quantity == 0) {
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        }
+        a.apply(ev);
+        b.apply(ev);
+        ASSERT(a.get_checksum() == b.get_checksum(), "Checksums should agree across configs");
+    }
+    BookDiff diff;
+    ASSERT(diff_books(a, b, diff), "Books fed the same flow should not differ");
+    for (uint64_t id : live) a.cancel_order(id);
+    ASSERT(a.get_total_orders() == 0 && a.get_checksum() == 0, "Empty book should checksum to 0");
+
+    // queue order is invisible to the checksum; the diff reports the one
+    // order that jumped, not the three it passed
+    RefBook x;
+    LadBook y;
+    for (uint64_t id : {1, 2, 3, 4}) x.add_order(Order(id, true, 99.50, 10, id));
+    for (uint64_t id : {2, 3, 4, 1}) y.add_order(Order(id, true, 99.50, 10, id));
+    ASSERT(x.get_checksum() == y.get_checksum(), "Checksum ignores FIFO order");
+    ASSERT(!diff_books(x, y, diff) && diff.levels.empty() && diff.orders.size() == 1, "One queue diff");
+    ASSERT(diff.orders[0].kind == OrderDiffKind::QueuePosition && diff.orders[0].order_id == 1 &&
+           diff.orders[0].position_a == 0 && diff.orders[0].position_b == 3, "Order 1 should have moved");
+
+    // a missing order and a changed quantity touch one level each
+    x.add_order(Order(5, false, 100.50, 7, 5));
+    y.add_order(Order(6, false, 100.60, 3, 6));
+    y.amend_order(2, 99.50, 4);
+    x.amend_order(2, 99.50, 4);
+    x.amend_order(3, 99.50, 9);
+    ASSERT(x.get_checksum() != y.get_checksum(), "Different orders should change the checksum");
+    ASSERT(!diff_books(x, y, diff), "Books should differ");
+    ASSERT(diff.levels.size() == 3, "Bid 99.50 and asks 100.50, 100.60 differ");
+    ASSERT(diff.levels[0].is_buy && diff.levels[0].quantity_a == 33 && diff.levels[0].quantity_b == 34,
+           "Bid level totals");
+    ASSERT(diff.levels[1].price == 100.50 && diff.levels[1].quantity_b == 0, "Ask only in a");
+    ASSERT(diff.orders.size() == 4, "Changed 3, only-in-a 5, only-in-b 6, moved 1");
+    ASSERT(diff.orders[0].kind == OrderDiffKind::Changed && diff.orders[0].order_id == 3, "Order 3 changed");
+
+    // bisection finds an event that introduces a difference; it is the first
+    // only while differences persist. b drops the add of order 2 (healed by
+    // its cancel) and of order 5 (never healed)
+    vector<OrderEvent> flow;
+    for (uint64_t id = 1; id <= 8; ++id) flow.push_back(OrderEvent::add(Order(id, true, (9900 + id) / 100.0, 10, id)));
+    flow.insert(flow.begin() + 3, OrderEvent::cancel(2, 3));
+    auto diverged = [&](uint64_t n) {
+        RefBook p;
+        LadBook q;
+        for (uint64_t i = 0; i < n; ++i) {
+            p.apply(flow[i]);
+            if (i != 1 && i != 5) q.apply(flow[i]);
+        }
+        return !diff_books(p, q, diff);
+    };
+    ASSERT(diverged(2) && !diverged(4) && !diverged(5) && diverged(6), "Order 2 heals, order 5 does not");
+    uint64_t n = bisect_divergence(0, flow.size(), diverged);
+    ASSERT(n == 6 && !diverged(n - 1), "Heal hides the first divergence from bisection");
+    ASSERT(bisect_divergence(4, flow.size(), diverged) == 6, "Bisection from a clean point past the heal");
+    ASSERT(bisect_divergence(0, 3, diverged) == 2, "Exact when nothing heals in the range");
+}
 
-    Timer timer;
+TEST(test_event_merge_loser_tree) {
+    // 300 venue streams split by order id from one flow with timestamp ties,
+    // plus an empty one: 301 leaves, so the tree is padded to 512
+    const uint32_t kStreams = 300;
+    mt19937_64 rng(29);
+    vector<vector<OrderEvent>> feeds(kStreams);
+    uint64_t ts = 34200ull * 1000000000ull;
+    for (uint64_t i = 0; i < 40000; ++i) {
+        ts += rng() % 3;    // a third of the events tie with the previous one
+        uint64_t id = 1 + rng() % 20000;
+        double price = double(9900 + int(rng() % 200)) / 100.0;
+        OrderEvent ev = rng() % 2 ? OrderEvent::add(Order(id, rng() & 1, price, 1 + rng() % 100, ts))
+                                  : OrderEvent::cancel(id, ts);
+        feeds[id % kStreams].push_back(ev);
+    }
 
-    // Add orders
-    timer.reset();
-    for (int i = 0; i < NUM_ORDERS; ++i) {
-        double price = 100.0 + (i % 1000) * 0.01;
-        book.add_order(Order(i, i % 2 == 0, price, 100 + i % 100, i));
+    // stream 0 from a columnar file (several chunks), 1 from a mapped row
+    // file, the rest spans
+    const string obc = "test_merge.obc", rpl = "test_merge.rpl";
+    feeds[0].resize(3 * ColumnarWriter::kChunkEvents, feeds[0].back());   // repeat the last event
+    {
+        ColumnarWriter cw(obc, 100);
+        ASSERT(cw.write(feeds[0].data(), feeds[0].size()) && cw.close(), "Columnar feed should write");
+        ReplayWriter rw(rpl);
+        ASSERT(rw.write(feeds[1].data(), feeds[1].size()) && rw.close(), "Row feed should write");
     }
-    double add_time_ms = timer.elapsed_ms();
 
-    cout << "\nAdded " << NUM_ORDERS << " orders in " << fixed << setprecision(2)
-              << add_time_ms << " ms\n";
-    cout << "Average: " << (add_time_ms * 1000000.0 / NUM_ORDERS) << " ns per order\n";
+    // expected: by timestamp, lowest stream first on ties, FIFO within a stream
+    vector<pair<uint32_t, OrderEvent>> expect;
+    for (uint32_t s = 0; s < kStreams; ++s) {
+        for (const OrderEvent& ev : feeds[s]) expect.emplace_back(s, ev);
+    }
+    stable_sort(expect.begin(), expect.end(), [](const auto& a, const auto& b) {
+        return a.second.timestamp_ns < b.second.timestamp_ns ||
+               (a.second.timestamp_ns == b.second.timestamp_ns && a.first < b.first);
+    });
+
+    EventMerger merger;
+    ASSERT(merger.add_file(obc) && merger.add_file(rpl), "Both files should open");
+    for (uint32_t s = 2; s < kStreams; ++s) merger.add_stream(feeds[s].data(), feeds[s].size());
+    merger.add_stream(nullptr, 0);
+    ASSERT(!merger.add_file("no_such_file.rpl"), "Missing file should be refused");
+    ASSERT(merger.size() == kStreams + 1, "One stream per input");
+    merger.start();
+
+    // first half through next(), the rest through drain()
+    size_t i = 0;
+    uint32_t stream;
+    for (; i < expect.size() / 2; ++i) {
+        const OrderEvent* ev = merger.next(stream);
+        ASSERT(ev && stream == expect[i].first && memcmp(ev, &expect[i].second, sizeof(OrderEvent)) == 0,
+               "next() should follow timestamp order");
+    }
+    bool in_order = true;
+    uint64_t drained = merger.drain([&](uint32_t s, const OrderEvent& ev) {
+        in_order = in_order && i < expect.size() && s == expect[i].first &&
+                   memcmp(&ev, &expect[i].second, sizeof(OrderEvent)) == 0;
+        ++i;
+    });
+    ASSERT(in_order && i == expect.size() && drained == expect.size() - expect.size() / 2,
+           "drain() should finish the merge in order");
+    ASSERT(!merger.next(stream), "Merged stream should end");
+
+    remove(obc.c_str());
+    remove(rpl.c_str());
+}
 
-    cout << "\nBook statistics:\n";
-    cout << "  Total orders: " << book.get_total_orders() << "\n";
-    cout << "  Bid levels: " << book.get_bid_levels() << "\n";
-    cout << "  Ask levels: " << book.get_ask_levels() << "\n";
+TEST(test_sim_exchange_queue_position_and_latency) {
+    // entry 10ns, market data 3ns, reports 5ns
+    SimLatency paths{LatencyModel::fixed(10), LatencyModel::fixed(3), LatencyModel::fixed(5)};
+    SimExchange sim(paths);
+
+    struct Recorder {
+        vector<SimReport> reports;
+        uint64_t market_events = 0, last_market_ns = 0;
+        void on_market(const OrderEvent&, uint64_t local_ns) {
+            ++market_events;
+            last_market_ns = local_ns;
+        }
+        void on_report(const SimReport& r) { reports.push_back(r); }
+    } strategy;
+
+    vector<OrderEvent> flow = {
+        OrderEvent::add(Order(1, true, 100.00, 100, 10)),
+        OrderEvent::add(Order(2, true, 100.00, 50, 20)),
+        OrderEvent::add(Order(3, false, 100.02, 15, 21)),
+        OrderEvent::add(Order(4, false, 100.03, 40, 22)),
+    };
+    sim.run(flow.data(), flow.size(), strategy);
+    // market data lags 3ns: by the event at 22 only the one at 10 was seen
+    ASSERT(strategy.market_events == 1 && strategy.last_market_ns == 13, "Market data lags by 3ns");
+
+    // bid joins behind 150 at t=35; a buy at 100.02 at t=36 takes the 15 shown
+    uint64_t bid = sim.submit(true, 100.00, 80, 25);
+    uint64_t lift = sim.submit(true, 100.02, 15, 26);
+    flow = {
+        OrderEvent::add(Order(10, false, 101.00, 1, 40)),    // unrelated, delivers the requests
+        OrderEvent::cancel(2, 41),                           // ahead: 150 -> 100
+        OrderEvent::add(Order(5, true, 100.00, 70, 42)),     // behind us
+        OrderEvent::execute(1, 100.00, 60, 43),              // ahead: 100 -> 40
+        OrderEvent::cancel(5, 44),                           // behind: no change
+        OrderEvent::amend(1, 100.00, 30, 45),                // ahead: 40 -> 30
+        OrderEvent::amend(1, 99.99, 30, 46),                 // repriced away: 30 -> 0
+        OrderEvent::add(Order(6, true, 100.00, 25, 47)),     // behind us
+    };
+    sim.run(flow.data(), flow.size(), strategy);
+    ASSERT(sim.resting(bid) && sim.queue_ahead(bid) == 0 && sim.leaves(bid) == 80, "Bid should be at the front");
+    ASSERT(!sim.resting(lift) && sim.leaves(lift) == 0, "Lift should be filled");
+    ASSERT(strategy.market_events == 8, "Market data of events up to t=43 delivered by 47");
+    ASSERT(strategy.reports.size() == 3, "Two acks and one fill so far");
+    const SimReport& taken = strategy.reports[2];
+    ASSERT(strategy.reports[0].kind == SimReportKind::Ack && strategy.reports[0].venue_ns == 35 &&
+           strategy.reports[0].local_ns == 40, "Ack at venue 35, seen at 40");
+    ASSERT(taken.kind == SimReportKind::Fill && taken.order_id == lift && taken.price == 100.02 &&
+           taken.quantity == 15 && taken.leaves == 0 && taken.local_ns == 41, "Aggressive fill at the ask shown");
+
+    // order 6 (behind us) trades: we fill first; then a sell added at 99.99
+    // crosses the rest of our bid
+    flow = {
+        OrderEvent::execute(6, 100.00, 25, 50),
+        OrderEvent::add(Order(7, false, 99.99, 200, 51)),
+        OrderEvent::add(Order(11, false, 101.00, 1, 60)),
+    };
+    sim.run(flow.data(), flow.size(), strategy);
+    ASSERT(!sim.resting(bid) && sim.leaves(bid) == 0, "Bid done");
+    ASSERT(strategy.reports.size() == 5, "Two more fills");
+    ASSERT(strategy.reports[3].order_id == bid && strategy.reports[3].quantity == 25 &&
+           strategy.reports[3].venue_ns == 50, "Trade behind us fills us first");
+    ASSERT(strategy.reports[4].order_id == bid && strategy.reports[4].quantity == 55 &&
+           strategy.reports[4].price == 100.00, "Crossing sell fills the bid at its price");
+
+    // a trade through a worse price fills a resting sell; a late cancel is rejected
+    uint64_t ask = sim.submit(false, 100.05, 30, 60);
+    flow = {OrderEvent::add(Order(8, false, 100.07, 50, 75)), OrderEvent::execute(8, 100.07, 20, 80)};
+    sim.run(flow.data(), flow.size(), strategy);
+    ASSERT(sim.leaves(ask) == 10, "Trade at 100.07 went through our 100.05 first");
+    sim.cancel(bid, 81);
+    sim.cancel(ask, 82);
+    sim.finish(strategy);
+    ASSERT(strategy.reports.back().kind == SimReportKind::Canceled && strategy.reports.back().quantity == 10,
+           "Ask cancel removes the rest");
+    ASSERT(sim.stats().rejected == 1 && sim.stats().canceled == 1 && sim.stats().filled_quantity == 115,
+           "Stats should add up");
+    for (size_t i = 1; i < strategy.reports.size(); ++i) {
+        ASSERT(strategy.reports[i].local_ns >= strategy.reports[i - 1].local_ns, "Reports arrive in order");
+    }
 
-    // Cancel half the orders
-    timer.reset();
-    for (int i = 0; i < NUM_ORDERS / 2; ++i) {
-        book.cancel_order(i * 2);
+    // distributions stay in range
+    mt19937_64 rng(3);
+    LatencyModel u = LatencyModel::uniform(100, 200), e = LatencyModel::empirical({7, 9});
+    LatencyModel ln = LatencyModel::lognormal(1000, 5000, 0.5);
+    vector<uint64_t> draws;
+    for (int i = 0; i < 10001; ++i) {
+        uint64_t a = u.sample(rng), b = e.sample(rng);
+        ASSERT(a >= 100 && a <= 200 && (b == 7 || b == 9), "Samples in range");
+        draws.push_back(ln.sample(rng));
     }
-    double cancel_time_ms = timer.elapsed_ms();
+    nth_element(draws.begin(), draws.begin() + 5000, draws.end());
+    ASSERT(draws[5000] > 5700 && draws[5000] < 6300, "Lognormal median near floor + median");
+}
 
-    cout << "\nCanceled " << (NUM_ORDERS / 2) << " orders in " << cancel_time_ms << " ms\n";
-    cout << "Average: " << (cancel_time_ms * 1000000.0 / (NUM_ORDERS / 2)) << " ns per cancel\n";
+TEST(test_batched_cancel_matches_one_by_one) {
+    // bursts with misses, repeats within a burst, out-of-range ids and
+    // bursts shorter than the prefetch distance, on both index kinds
+    auto check = [](auto& batched, auto& single) {
+        mt19937_64 rng(97);
+        vector<uint64_t> ids;
+        for (uint64_t id = 1; id <= 5000; ++id) {
+            bool is_buy = rng() & 1;
+            double price = double(10000 + (is_buy ? -1 : 1) * int64_t(1 + rng() % 40)) / 100.0;
+            Order o(id * 3, is_buy, price, 1 + rng() % 100, id);
+            batched.add_order(o);
+            single.add_order(o);
+            ids.push_back(id * 3);
+        }
+        shuffle(ids.begin(), ids.end(), rng);
+
+        vector<uint64_t> burst;
+        size_t pos = 0;
+        while (pos < ids.size()) {
+            burst.clear();
+            size_t n = 1 + rng() % 40;
+            for (size_t k = 0; k < n && pos < ids.size(); ++k) {
+                unsigned roll = rng() % 20;
+                if (roll == 0) {
+                    burst.push_back(ids[pos] + 1);              // never added
+                } else if (roll == 1 && !burst.empty()) {
+                    burst.push_back(burst[rng() % burst.size()]);   // already canceled
+                } else if (roll == 2) {
+                    burst.push_back(UINT64_MAX - rng() % 4);    // beyond a direct index
+                } else {
+                    burst.push_back(ids[pos++]);
+                }
+            }
+            size_t expected = 0;
+            for (uint64_t id : burst) expected += single.cancel_order(id);
+            ASSERT(batched.cancel_orders(burst.data(), burst.size()) == expected,
+                   "Batch should cancel exactly what one-by-one cancels do");
+            ASSERT(batched.get_checksum() == single.get_checksum(), "Books should hold the same orders");
+        }
+        ASSERT(batched.get_total_orders() == 0 && batched.get_bid_levels() == 0 && batched.get_ask_levels() == 0,
+               "Every order and level should be gone");
+        ASSERT(batched.get_counters().orders_canceled.load() == 5000, "Each cancel should be counted once");
+        ASSERT(batched.cancel_orders(nullptr, 0) == 0, "Empty batch is a no-op");
+    };
+
+    BasicOrderBook<WithChecksum<DefaultConfig>> a, b;
+    check(a, b);
+    BasicOrderBook<WithChecksum<LadderConfig<100, 512, 1000000>>> c, d;
+    check(c, d);
+}
 
-    cout << "\nBook statistics after cancels:\n";
-    cout << "  Total orders: " << book.get_total_orders() << "\n";
-    cout << "  Bid levels: " << book.get_bid_levels() << "\n";
-    cout << "  Ask levels: " << book.get_ask_levels() << "\n";
+TEST(test_batch_apply_publishes_one_delta_per_level) {
+    // batched and one-by-one books over the same flow: same accepts, same
+    // orders, and per batch exactly one delta per level the one-by-one book
+    // reported, in first-touch order with the last quantity it reported
+    auto check = [](auto& batched, auto& single) {
+        mt19937_64 rng(98);
+        vector<LevelDelta> got, want;
+        batched.set_delta_sink(&got);
+        single.set_delta_sink(&want);
+        vector<uint64_t> live;
+        unordered_map<uint64_t, double> price_of;
+        uint64_t next_id = 1, ts = 1;
+        vector<OrderEvent> batch;
+        for (int round = 0; round < 400; ++round) {
+            batch.clear();
+            size_t n = round % 50 == 49 ? 2000 : rng() % 70;     // some batches outgrow the level table
+            for (size_t k = 0; k < n; ++k, ++ts) {
+                unsigned roll = rng() % 10;
+                if (live.empty() || roll < 4) {
+                    bool is_buy = rng() & 1;
+                    double price = double(10000 + (is_buy ? -1 : 1) * int64_t(1 + rng() % 200)) / 100.0;
+                    batch.push_back(OrderEvent::add(Order(next_id, is_buy, price, 1 + rng() % 100, ts)));
+                    price_of[next_id] = price;
+                    live.push_back(next_id++);
+                    continue;
+                }
+                size_t pick = rng() % live.size();
+                uint64_t id = live[pick];
+                if (roll < 6) {
+                    batch.push_back(OrderEvent::cancel(rng() % 16 ? id : id + 1000000, ts));
+                } else if (roll < 8) {
+                    double price = rng() % 3 ? price_of[id] : price_of[id] + 0.01;
+                    batch.push_back(OrderEvent::amend(id, price, rng() % 60, ts));
+                    price_of[id] = price;
+                } else {
+                    batch.push_back(OrderEvent::execute(id, price_of[id], 1 + rng() % 40, ts));
+                }
+            }
+
+            got.clear();
+            want.clear();
+            size_t accepted = 0;
+            for (const OrderEvent& ev : batch) accepted += single.apply(ev);
+            ASSERT(batched.apply(batch.data(), batch.size()) == accepted, "Batch should accept what one-by-one does");
+            ASSERT(batched.get_checksum() == single.get_checksum(), "Books should hold the same orders");
+
+            vector<LevelDelta> expected;
+            for (const LevelDelta& d : want) {
+                auto same = [&](const LevelDelta& e) { return e.is_buy == d.is_buy && e.price == d.price; };
+                auto it = find_if(expected.begin(), expected.end(), same);
+                if (it == expected.end()) expected.push_back(d); else it->quantity = d.quantity;
+            }
+            ASSERT(got.size() == expected.size(), "One delta per touched level");
+            for (size_t i = 0; i < got.size(); ++i) {
+                ASSERT(got[i].is_buy == expected[i].is_buy && got[i].price == expected[i].price &&
+                       got[i].quantity == expected[i].quantity, "Delta should carry the level's final quantity");
+            }
+
+            // forget ids the books no longer hold
+            for (size_t i = 0; i < live.size();) {
+                if (!single.find_order(live[i])) {
+                    live[i] = live.back();
+                    live.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+        BookDiff diff;
+        ASSERT(diff_books(batched, single, diff), "Books should match in full");
+
+        // no sink: nothing recorded, single-event path unchanged afterwards
+        batched.set_delta_sink(nullptr);
+        OrderEvent ev = OrderEvent::add(Order(next_id, true, 96.0, 5, ts));     // a level of its own
+        ASSERT(batched.apply(&ev, 1) == 1, "Batch without a sink applies");
+        got.clear();
+        batched.set_delta_sink(&got);
+        batched.cancel_order(next_id);
+        ASSERT(got.size() == 1 && got[0].quantity == 0, "Single events publish immediately again");
+    };
+
+    BasicOrderBook<WithChecksum<DefaultConfig>> a, b;
+    check(a, b);
+    BasicOrderBook<WithChecksum<LadderConfig<100, 1024, 1000000>>> c, d;
+    check(c, d);
+}
+
+struct BranchyLadderConfig : WithChecksum<LadderConfig<100, 256, 1000000>> {
+    static constexpr bool kBranchlessLevels = false;
+};
+
+TEST(test_branchless_level_kernels_match_branchy) {
+    // the select helper on both operand kinds
+    int x = 1, y = 2;
+    ASSERT(branchless_select(true, &x, &y) == &x && branchless_select(false, &x, &y) == &y, "Pointer select");
+    ASSERT(branchless_select(true, int64_t(-5), int64_t(7)) == -5 &&
+           branchless_select(false, uint32_t(1), UINT32_MAX) == UINT32_MAX, "Integer select");
+
+    // ladder side: release drops only emptied levels, find outside the window
+    struct Slot {
+        uint64_t quantity = 0;
+        bool empty() const { return quantity == 0; }
+    };
+    LadderSide<int64_t, Slot, true, 128> side;
+    side.level(1000).quantity = 5;
+    side.level(1001);
+    ASSERT(side.size() == 2 && side.find(1001) && !side.find(1002), "Levels found by occupancy");
+    ASSERT(!side.find(1000 - 64 - 1) && !side.find(1000 + 64) && !side.find(INT64_MIN) && !side.find(INT64_MAX),
+           "Out of window");
+    ASSERT(!side.accepts(INT64_MIN) && !side.accepts(INT64_MAX), "Extreme keys are outside the window");
+    side.level(1000);
+    ASSERT(side.size() == 2, "Re-touching a level does not recount it");
+    side.release(1000);
+    side.release(1001);
+    ASSERT(side.size() == 1 && side.find(1000) && !side.find(1001), "Only the empty level released");
+
+    // thin levels (a few orders per tick) so head, tail, middle and last
+    // removals all happen; queue order checked by diff_books
+    BasicOrderBook<BranchyLadderConfig> branchy;
+    BasicOrderBook<WithChecksum<LadderConfig<100, 256, 1000000>>> branchless;
+    BasicOrderBook<WithChecksum<DefaultConfig>> reference;
+    mt19937_64 rng(99);
+    vector<pair<uint64_t, int64_t>> live;     // id, price in ticks
+    uint64_t next_id = 1;
+    BookDiff diff;
+    for (uint64_t ts = 1; ts <= 40000; ++ts) {
+        OrderEvent ev;
+        unsigned roll = rng() % 100;
+        if (live.empty() || roll < (live.size() < 100 ? 60u : 40u)) {
+            bool is_buy = rng() & 1;
+            int64_t tick = 10000 + (is_buy ? -1 : 1) * int64_t(1 + rng() % 30);
+            ev = OrderEvent::add(Order(next_id, is_buy, double(tick) / 100.0, 1 + rng() % 100, ts));
+            live.emplace_back(next_id++, tick);
+        } else {
+            size_t pick = rng() % live.size();
+            auto [id, tick] = live[pick];
+            if (roll < 85) {
+                ev = OrderEvent::cancel(id, ts);
+            } else if (roll < 93) {
+                int64_t moved = tick + (rng() & 1 ? 1 : -1) * int64_t(rng() % 2);
+                ev = OrderEvent::amend(id, double(moved) / 100.0, rng() % 50, ts);
+                live[pick].second = moved;
+            } else {
+                ev = OrderEvent::execute(id, double(tick) / 100.0, 1 + rng() % 60, ts);
+            }
+        }
+        bool a = branchy.apply(ev), b = branchless.apply(ev), c = reference.apply(ev);
+        ASSERT(a == b && b == c, "Configs should accept the same events");
+        ASSERT(branchy.get_checksum() == branchless.get_checksum(), "Same resting orders");
+        if (ev.type != EventType::Add) {
+            for (size_t i = 0; i < live.size(); ++i) {
+                if (live[i].first == ev.order_id && !reference.find_order(ev.order_id)) {
+                    live[i] = live.back();
+                    live.pop_back();
+                    break;
+                }
+            }
+        }
+        if (ts % 1000 == 0) {
+            ASSERT(diff_books(branchy, branchless, diff), "Same levels and queue order");
+            ASSERT(diff_books(reference, branchless, diff), "Same as the tree book");
+            ASSERT(branchy.get_bid_levels() == branchless.get_bid_levels() &&
+                   branchy.get_ask_levels() == branchless.get_ask_levels(), "Same level counts");
+        }
+    }
+    for (const auto& entry : live) branchless.cancel_order(entry.first);
+    ASSERT(branchless.get_total_orders() == 0 && branchless.get_bid_levels() == 0 &&
+           branchless.get_ask_levels() == 0, "Every level released");
+    ASSERT(branchless.add_order(Order(next_id, true, 50.0, 1, 0)), "Empty ladder re-anchors");
+}
+
+TEST(test_pool_handoff_across_threads) {
+    // gateway thread allocates events from a small pool and hands them to a
+    // book thread, which applies and releases them; slots are recycled
+    // through the batched return ring many times over
+    const uint64_t N = 300000;
+    vector<OrderEvent> flow;
+    {
+        mt19937_64 rng(100);
+        vector<uint64_t> live;
+        for (uint64_t ts = 1; flow.size() < N; ++ts) {
+            if (live.empty() || rng() % 2) {
+                bool is_buy = rng() & 1;
+                double price = double(10000 + (is_buy ? -1 : 1) * int64_t(1 + rng() % 50)) / 100.0;
+                flow.push_back(OrderEvent::add(Order(ts, is_buy, price, 1 + rng() % 100, ts)));
+                live.push_back(ts);
+            } else {
+                size_t pick = rng() % live.size();
+                flow.push_back(OrderEvent::cancel(live[pick], ts));
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        }
+    }
+
+    PoolHandoff<OrderEvent> handoff(256);
+    const size_t capacity = handoff.capacity();
+    uint64_t stalls = 0;
+    thread gateway([&] {
+        for (const OrderEvent& ev : flow) {
+            PoolHandoff<OrderEvent>::Handle h;
+            while ((h = handoff.allocate(ev)) == PoolHandoff<OrderEvent>::kNullHandle) {
+                ++stalls;
+                this_thread::yield();
+            }
+            handoff.send(h);
+        }
+    });
+
+    BasicOrderBook<WithChecksum<DefaultConfig>> book;
+    uint64_t received = 0, in_order = 0;
+    thread consumer([&] {
+        while (received < N) {
+            size_t n = handoff.consume([&](const OrderEvent& ev) {
+                in_order += memcmp(&ev, &flow[received], sizeof(ev)) == 0;
+                ++received;
+                book.apply(ev);
+            });
+            if (n == 0) {
+                handoff.flush();        // idle: hand back the partial batch
+                this_thread::yield();
+            }
+        }
+        handoff.flush();
+    });
+    gateway.join();
+    consumer.join();
+
+    ASSERT(received == N && in_order == N, "Every event arrives intact and in order");
+    BasicOrderBook<WithChecksum<DefaultConfig>> serial;
+    for (const OrderEvent& ev : flow) serial.apply(ev);
+    ASSERT(book.get_checksum() == serial.get_checksum(), "Book matches a single-threaded apply");
+    ASSERT(handoff.capacity() == capacity && capacity < N / 100, "Pool never grew; slots were recycled");
+    handoff.reclaim();
+    ASSERT(handoff.in_use() == 0, "Every slot comes back to the owner");
+
+    // many partial batches with no reclaim overflow the return ring into
+    // the book side's backlog; nothing is lost
+    PoolHandoff<OrderEvent> small(4096);
+    size_t sent = 0;
+    for (PoolHandoff<OrderEvent>::Handle h; (h = small.allocate(flow[sent])) != PoolHandoff<OrderEvent>::kNullHandle;) {
+        small.send(h);
+        ++sent;
+    }
+    ASSERT(sent == small.capacity(), "Allocation stops at capacity");
+    for (PoolHandoff<OrderEvent>::Handle h; small.receive(h);) {
+        small.release(h);
+        small.flush();
+    }
+    size_t reclaimed = 0;
+    for (int round = 0; round < 100 && small.in_use(); ++round) {
+        reclaimed += small.reclaim();
+        small.flush();
+    }
+    ASSERT(reclaimed == sent && small.in_use() == 0, "Backlogged batches are returned in later flushes");
+}
+
+TEST(test_reserved_owner_rejected) {
+    // kNoOwner marks free column slots; an order carrying it would let a
+    // mass cancel of that owner erase free and never-used slots
+    for (bool columns : {false, true}) {
+        OrderBook book(columns);
+        book.add_order(Order(1, true, 100.0, 10, 1, 7));
+        ASSERT(!book.add_order(Order(2, true, 100.0, 10, 2, OrderColumns::kNoOwner)), "Reserved owner rejected");
+        book.add_order(Order(3, false, 101.0, 10, 3, 7));
+        book.cancel_order(3);       // leaves a free slot behind
+        ASSERT(book.get_owner_quantity(OrderColumns::kNoOwner) == 0, "Free slots add no quantity");
+        ASSERT(book.cancel_all_for_owner(OrderColumns::kNoOwner) == 0, "Nothing matches the reserved owner");
+        ASSERT(book.get_total_orders() == 1 && book.get_bid_levels() == 1, "Book untouched");
+        ASSERT(book.add_order(Order(4, false, 101.0, 5, 4, 7)) && book.cancel_all_for_owner(7) == 2,
+               "Pool and levels still consistent");
+        ASSERT(book.get_total_orders() == 0, "Every order of owner 7 canceled");
+    }
+}
+
+TEST(test_rejected_reprice_leaves_book_unchanged) {
+    TestLadderBook book;        // 512 ticks around the first price
+    book.add_order(Order(1, true, 100.00, 10, 1, 0, 5000));
+    book.add_order(Order(2, true, 100.00, 20, 2));
+    book.add_order(Order(3, true, 99.99, 30, 3));
+
+    ASSERT(!book.amend_order(1, 200.00, 10, 4), "Reprice outside the band rejected");
+    ASSERT(!book.amend_order(1, 99.99, 0, 4), "Reprice to 0 rejected");
+    const Order* o = book.find_order(1);
+    ASSERT(o && o->price == 100.00 && o->quantity == 10 && o->timestamp_ns == 1, "Order unchanged");
+    vector<Order> orders;
+    book.get_orders(orders);
+    ASSERT(orders.size() == 3 && orders[0].order_id == 1 && orders[1].order_id == 2, "Still first in its queue");
+    ASSERT(book.get_top().bid.total_quantity == 30, "Level quantity unchanged");
+
+    // an accepted reprice keeps the expiry timer armed
+    ASSERT(book.amend_order(1, 99.99, 15, 4), "Reprice in band accepted");
+    ASSERT(book.get_top().bid.total_quantity == 20, "Moved off the old level");
+    ASSERT(book.expire_orders(6000) == 1 && !book.find_order(1), "Expiry still fires after the move");
+
+    // the only order on a ladder side can move anywhere: the side re-anchors
+    TestLadderBook lone;
+    lone.add_order(Order(1, false, 100.00, 10, 1));
+    ASSERT(lone.amend_order(1, 150.00, 10, 2) && lone.find_order(1)->price == 150.00, "Lone order re-anchors");
+}
+
+TEST(test_metrics_slot_reuse_and_rate) {
+    MetricsRegistry registry;
+    string path = "orderbook_metrics_reuse_test.txt";
+    auto read_rate = [&] {
+        FILE* f = fopen(path.c_str(), "r");
+        char buf[4096];
+        size_t n = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+        buf[n] = '\0';
+        if (f) fclose(f);
+        const char* line = strstr(buf, "orderbook_messages_per_second ");
+        return line ? strtod(line + strlen("orderbook_messages_per_second "), nullptr) : -1.0;
+    };
+
+    // released blocks go back to the table: far more books than kMaxBooks over time
+    for (int i = 0; i < 1000; ++i) {
+        OrderBook book;
+        ASSERT(book.attach_metrics(registry, "churn"), "Released slot should be reused");
+        book.add_order(Order(1, true, 100.0, 10, 1000));
+    }
+    ASSERT(registry.size() == 1, "One book at a time needs one slot");
+
+    // a released book must not drive the rate negative (i.e. wrap to ~1e19)
+    MetricsExporter exporter(registry, path);
+    {
+        OrderBook busy;
+        busy.attach_metrics(registry, "busy");
+        for (uint64_t id = 1; id <= 1000; ++id) busy.add_order(Order(id, true, 100.0, 1, 1000));
+        exporter.export_now();
+    }
+    OrderBook fresh;
+    fresh.attach_metrics(registry, "fresh");
+    fresh.add_order(Order(1, true, 100.0, 10, 1000));
+    this_thread::sleep_for(chrono::milliseconds(1));
+    exporter.export_now();
+    double rate = read_rate();
+    remove(path.c_str());
+    ASSERT(rate >= 0.0 && rate < 1e7, "Rate should count only the new message");
+    ASSERT(registry.total().messages == 1, "Reused block starts from zero");
+
+    // a reader copying a name while the slot is released and re-acquired
+    // gets one whole name or none, never a mix
+    {
+        MetricsRegistry churn;
+        const string names[2] = {string(40, 'a'), string(40, 'b')};
+        atomic<bool> done{false};
+        bool torn = false;
+        thread reader([&] {
+            string got;
+            while (!done.load()) {
+                if (!churn.read_name(0, got)) continue;
+                torn = torn || (got != names[0] && got != names[1]);
+            }
+        });
+        for (int i = 0; i < 20000; ++i) {
+            BookCounters* c = churn.acquire(names[i & 1].c_str());
+            churn.release(c);
+        }
+        done = true;
+        reader.join();
+        ASSERT(!torn, "Names should never be torn by a reuse");
+        string got;
+        ASSERT(!churn.read_name(0, got), "A released slot has no name to export");
+    }
+
+    // stop() wakes the exporter instead of sleeping out the interval
+    MetricsExporter slow(registry, path, chrono::milliseconds(10000));
+    slow.start();
+    this_thread::sleep_for(chrono::milliseconds(20));
+    auto t0 = chrono::steady_clock::now();
+    slow.stop();
+    ASSERT(chrono::steady_clock::now() - t0 < chrono::seconds(2), "Stop should not wait a full interval");
+    remove(path.c_str());
+}
+
+TEST(test_sim_exchange_takes_liquidity_once) {
+    SimExchange sim(SimLatency{LatencyModel::fixed(10), LatencyModel::fixed(0), LatencyModel::fixed(0)});
+    struct Quiet {
+        void on_market(const OrderEvent&, uint64_t) {}
+        void on_report(const SimReport&) {}
+    } strategy;
+
+    // one 10-lot ask and a 30-lot bid; two 10-lot buys cross the ask together
+    vector<OrderEvent> flow = {OrderEvent::add(Order(1, false, 100.00, 10, 10)),
+                               OrderEvent::add(Order(2, true, 99.00, 30, 11))};
+    sim.run(flow.data(), flow.size(), strategy);
+    uint64_t first = sim.submit(true, 100.00, 10, 20);
+    uint64_t second = sim.submit(true, 100.00, 10, 20);
+    uint64_t hit = sim.submit(false, 99.00, 10, 21);
+    uint64_t join = sim.submit(true, 99.00, 5, 22);
+    flow = {OrderEvent::add(Order(3, false, 101.00, 1, 50))};
+    sim.run(flow.data(), flow.size(), strategy);
+
+    ASSERT(sim.leaves(first) == 0 && !sim.resting(first), "First buy takes the 10 shown");
+    ASSERT(sim.resting(second) && sim.leaves(second) == 10, "Second buy finds nothing left and rests");
+    ASSERT(sim.leaves(hit) == 0 && sim.queue_ahead(join) == 20, "Bid we hit shows 20 ahead of a joiner");
+    ASSERT(sim.stats().filled_quantity == 20, "Each lot fills once");
+
+    // a historical change to the level makes its quantity fresh again
+    uint64_t again = sim.submit(false, 99.00, 40, 60);
+    flow = {OrderEvent::execute(2, 99.00, 5, 55), OrderEvent::add(Order(4, false, 101.00, 1, 80))};
+    sim.run(flow.data(), flow.size(), strategy);
+    ASSERT(sim.leaves(again) == 40 - 25, "The 25 left historically fill again");
+    ASSERT(sim.queue_ahead(join) == 0, "Taking the level clears the queue ahead of our bid");
 }
 
 // ============================================================================
@@ -476,39 +1848,5 @@ int main() {
         return 1;
     }
 
-    cout << "\n" << string(70, '=') << "\n";
-    cout << "PERFORMANCE BENCHMARKS\n";
-    cout << string(70, '=') << "\n";
-
-    benchmark_add_order();
-    benchmark_cancel_order();
-    benchmark_amend_order_quantity();
-    benchmark_amend_order_price();
-    benchmark_get_snapshot();
-
-    stress_test_large_book();
-
-    // Demonstrate the order book
-    cout << "\n" << string(70, '=') << "\n";
-    cout << "DEMONSTRATION\n";
-    cout << string(70, '=') << "\n";
-
-    OrderBook demo_book;
-
-    // Add some orders
-    demo_book.add_order(Order(1, true, 99.50, 100, 1000));
-    demo_book.add_order(Order(2, true, 99.45, 200, 2000));
-    demo_book.add_order(Order(3, true, 99.40, 150, 3000));
-    demo_book.add_order(Order(4, true, 99.50, 50, 4000));
-
-    demo_book.add_order(Order(5, false, 100.00, 100, 5000));
-    demo_book.add_order(Order(6, false, 100.05, 200, 6000));
-    demo_book.add_order(Order(7, false, 100.10, 150, 7000));
-    demo_book.add_order(Order(8, false, 100.00, 75, 8000));
-
-    demo_book.print_book(5);
-
-    cout << "\nAll tests and benchmarks completed successfully!\n\n";
-
     return 0;
 }